@@ -0,0 +1,106 @@
+// Copyright (c) 2015-2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sys/time.h>
+
+benchmark::BenchRunner::BenchmarkMap &benchmark::BenchRunner::benchmarks() {
+    static std::map<std::string, benchmark::BenchFunction> benchmarks_map;
+    return benchmarks_map;
+}
+
+static double gettimedouble(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_usec * 0.000001 + tv.tv_sec;
+}
+
+benchmark::BenchRunner::BenchRunner(std::string name, benchmark::BenchFunction func)
+{
+    benchmarks().insert(std::make_pair(name, func));
+}
+
+std::vector<benchmark::Result>
+benchmark::BenchRunner::RunAll(const std::string& filter, double elapsedTimeForOne)
+{
+    std::vector<Result> results;
+    for (BenchmarkMap::iterator it = benchmarks().begin(); it != benchmarks().end(); ++it) {
+        if (it->first.compare(0, filter.size(), filter) != 0)
+            continue;
+        State state(it->first, elapsedTimeForOne);
+        it->second(state);
+        if (state.GetCount() == 0)
+            continue;
+        Result result;
+        result.name = state.GetName();
+        result.count = state.GetCount();
+        result.min = state.GetMinTime();
+        result.max = state.GetMaxTime();
+        result.average = state.GetElapsed() / state.GetCount();
+        results.push_back(result);
+    }
+    return results;
+}
+
+bool benchmark::State::KeepRunning()
+{
+    if (count & countMask) {
+      ++count;
+      return true;
+    }
+    double now;
+    if (count == 0) {
+        lastTime = beginTime = now = gettimedouble();
+    }
+    else {
+        now = gettimedouble();
+        double elapsed = now - lastTime;
+        double elapsedOne = elapsed * countMaskInv;
+        if (elapsedOne < minTime) minTime = elapsedOne;
+        if (elapsedOne > maxTime) maxTime = elapsedOne;
+        if (elapsed*128 < maxElapsed) {
+          // If the execution was much too fast (1/128th of maxElapsed), increase the count mask by 8x and restart timing.
+          // The restart avoids including the overhead of this code in the measurement.
+          countMask = ((countMask<<3)|7) & ((1LL<<60)-1);
+          countMaskInv = 1./(countMask+1);
+          count = 0;
+          minTime = std::numeric_limits<double>::max();
+          maxTime = std::numeric_limits<double>::min();
+          return KeepRunning();
+        }
+    }
+    lastTime = now;
+    ++count;
+
+    if (now - beginTime < maxElapsed) return true; // Keep going
+
+    --count;
+    return false;
+}
+
+void benchmark::PrintCSV(const std::vector<Result>& results)
+{
+    std::cout << "#Benchmark" << "," << "count" << "," << "min" << "," << "max" << "," << "average" << "\n";
+    for (const Result& result : results) {
+        std::cout << std::fixed << std::setprecision(15) << result.name << "," << result.count << ","
+                  << result.min << "," << result.max << "," << result.average << "\n";
+    }
+}
+
+void benchmark::PrintJSON(const std::vector<Result>& results)
+{
+    // benchmark names are C identifiers, nothing to escape
+    std::cout << "[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        std::cout << (i ? ",\n " : "\n ") << std::fixed << std::setprecision(15)
+                  << "{\"name\": \"" << result.name << "\", \"count\": " << result.count
+                  << ", \"min\": " << result.min << ", \"max\": " << result.max
+                  << ", \"average\": " << result.average << "}";
+    }
+    std::cout << "\n]\n";
+}
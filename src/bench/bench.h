@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BENCH_BENCH_H
+#define BITCOIN_BENCH_BENCH_H
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+// Simple micro-benchmarking framework; API mostly matches a subset of the Google Benchmark
+// framework (see https://github.com/google/benchmark)
+// Wiki of using that framework is here: https://github.com/google/benchmark/wiki
+//
+// Why not use the Google Benchmark framework? Because adding Yet Another Dependency
+// (that uses cmake as its build system and has lots of features we don't need) isn't
+// worth it.
+
+/*
+ * Usage:
+
+static void CODE_TO_TIME(benchmark::State& state)
+{
+    ... do any setup needed...
+    while (state.KeepRunning()) {
+       ... do stuff you want to time...
+    }
+    ... do any cleanup needed...
+}
+
+BENCHMARK(CODE_TO_TIME);
+
+ */
+
+namespace benchmark {
+
+    class State {
+        std::string name;
+        double maxElapsed;
+        double beginTime;
+        double lastTime, minTime, maxTime, countMaskInv;
+        int64_t count;
+        int64_t countMask;
+    public:
+        State(std::string _name, double _maxElapsed) : name(_name), maxElapsed(_maxElapsed), count(0) {
+            minTime = std::numeric_limits<double>::max();
+            maxTime = std::numeric_limits<double>::min();
+            countMask = 0;
+            countMaskInv = 1.;
+            beginTime = lastTime = 0.;
+        }
+        bool KeepRunning();
+
+        const std::string& GetName() const { return name; }
+        int64_t GetCount() const { return count; }
+        double GetMinTime() const { return minTime; }
+        double GetMaxTime() const { return maxTime; }
+        double GetElapsed() const { return lastTime - beginTime; }
+    };
+
+    typedef std::function<void(State&)> BenchFunction;
+
+    // Timings of one benchmark, all times are in seconds per iteration
+    struct Result {
+        std::string name;
+        int64_t count;
+        double min;
+        double max;
+        double average;
+    };
+
+    class BenchRunner
+    {
+        typedef std::map<std::string, BenchFunction> BenchmarkMap;
+        static BenchmarkMap &benchmarks();
+
+    public:
+        BenchRunner(std::string name, BenchFunction func);
+
+        // Runs benchmarks whose name starts with filter (all if empty), each one for about elapsedTimeForOne seconds
+        static std::vector<Result> RunAll(const std::string& filter = "", double elapsedTimeForOne = 1.0);
+    };
+
+    // Writes the results as "name,count,min,max,average" lines preceded by a header
+    void PrintCSV(const std::vector<Result>& results);
+    // Writes the results as a JSON array of objects with the same fields as the CSV output
+    void PrintJSON(const std::vector<Result>& results);
+}
+
+// BENCHMARK(foo) expands to:  benchmark::BenchRunner bench_11foo("foo", foo);
+#define BENCHMARK(n) \
+    benchmark::BenchRunner BOOST_PP_CAT(bench_, BOOST_PP_CAT(__LINE__, n))(BOOST_PP_STRINGIZE(n), n);
+
+#endif // BITCOIN_BENCH_BENCH_H
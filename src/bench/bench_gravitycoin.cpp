@@ -0,0 +1,58 @@
+// Copyright (c) 2015 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "chainparams.h"
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "key.h"
+#include "util.h"
+#include "utilstrencodings.h"
+
+#include <cstdio>
+
+static const char* DEFAULT_BENCH_PRINTER = "csv";
+static const char* DEFAULT_BENCH_FILTER = "";
+static const int64_t DEFAULT_BENCH_TIME_MS = 1000;
+
+int
+main(int argc, char** argv)
+{
+    ParseParameters(argc, argv);
+
+    if (mapArgs.count("-?") || mapArgs.count("-h") || mapArgs.count("-help")) {
+        std::string strUsage = HelpMessageGroup("Options:");
+        strUsage += HelpMessageOpt("-?", "This help message");
+        strUsage += HelpMessageOpt("-filter=<prefix>", strprintf("Only run benchmarks whose name starts with <prefix> (default: \"%s\")", DEFAULT_BENCH_FILTER));
+        strUsage += HelpMessageOpt("-printer=<csv|json>", strprintf("Output format of the results (default: %s)", DEFAULT_BENCH_PRINTER));
+        strUsage += HelpMessageOpt("-time=<n>", strprintf("Run every benchmark for about <n> milliseconds (default: %d)", DEFAULT_BENCH_TIME_MS));
+        fprintf(stdout, "%s", strUsage.c_str());
+        return 0;
+    }
+
+    std::string printer = GetArg("-printer", DEFAULT_BENCH_PRINTER);
+    if (printer != "csv" && printer != "json") {
+        fprintf(stderr, "Error: unknown printer %s\n", printer.c_str());
+        return 1;
+    }
+
+    ECC_Start();
+    SetupEnvironment();
+    fPrintToDebugLog = false; // don't want to write to debug.log file
+    // sigma parameters and consensus checks are those of the main network
+    SelectParams(CBaseChainParams::MAIN);
+    // measure the Lyra2 row operations the node would use
+    selectRowFunctions();
+
+    std::vector<benchmark::Result> results = benchmark::BenchRunner::RunAll(
+        GetArg("-filter", DEFAULT_BENCH_FILTER), GetArg("-time", DEFAULT_BENCH_TIME_MS) / 1000.0);
+
+    if (printer == "json")
+        benchmark::PrintJSON(results);
+    else
+        benchmark::PrintCSV(results);
+
+    ECC_Stop();
+    return 0;
+}
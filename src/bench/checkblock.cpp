@@ -0,0 +1,117 @@
+// Copyright (c) 2019 The GravityCoin Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "sigma_data.h"
+
+#include "chainparams.h"
+#include "consensus/merkle.h"
+#include "consensus/validation.h"
+#include "main.h"
+#include "sigma.h"
+#include "streams.h"
+#include "util.h"
+#include "version.h"
+#include "sigma/coinspend.h"
+
+#include <cassert>
+
+// Block at the first sigma height with a coinbase, sigma spends of coins of a single
+// group and fresh mints, checked the way a block received from the network is.
+static const int CHECKBLOCK_SPENDS = 20;
+static const int CHECKBLOCK_MINTS = 100;
+static const int CHECKBLOCK_SET_SIZE = 1024;
+
+static void CheckBlockSigma(benchmark::State& state)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    const Consensus::Params& consensus = Params().GetConsensus();
+    const sigma::CoinDenomination denomination = sigma::CoinDenomination::SIGMA_DENOM_X1;
+    const int coinGroupId = 1;
+    int64_t denominationValue;
+    sigma::DenominationToInteger(denomination, denominationValue);
+
+    // proofs would otherwise be verified once and then found in the cache
+    SoftSetArg("-maxsigmaproofcachesize", "0");
+
+    // Spent coins are at the end of a set connected to the state in a single block
+    std::vector<sigma::PrivateCoin> coins;
+    std::vector<sigma::PublicCoin> anonymitySet;
+    for (const GroupElement& value : BenchGroupElements(CHECKBLOCK_SET_SIZE - CHECKBLOCK_SPENDS))
+        anonymitySet.emplace_back(value, denomination);
+    for (int i = 0; i < CHECKBLOCK_SPENDS; i++) {
+        coins.emplace_back(params, denomination);
+        anonymitySet.push_back(coins.back().getPublicCoin());
+    }
+
+    uint256 setBlockHash = uint256S("0x01");
+    CBlockIndex setBlock;
+    setBlock.nHeight = consensus.nSigmaStartBlock;
+    setBlock.phashBlock = &setBlockHash;
+
+    sigma::CSigmaBlockData setBlockData;
+    setBlockData.mints[std::make_pair(denomination, coinGroupId)] = anonymitySet;
+    sigma::CSigmaState* sigmaState = sigma::CSigmaState::GetState();
+    sigmaState->Reset();
+    sigmaState->AddBlock(&setBlock, setBlockData);
+
+    CBlock block;
+    int nHeight = setBlock.nHeight + 1;
+
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << nHeight << OP_0;
+    coinbase.vout.push_back(CTxOut(50 * COIN, CScript() << OP_TRUE));
+    block.vtx.push_back(coinbase);
+
+    for (int i = 0; i < CHECKBLOCK_SPENDS; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout.n = coinGroupId;
+        tx.vout.push_back(CTxOut(denominationValue, CScript() << OP_TRUE));
+
+        // the spend signs the transaction without its scriptSig
+        sigma::SpendMetaData metaData(coinGroupId, setBlockHash, tx.GetHash());
+        sigma::CoinSpend spend(params, coins[i], anonymitySet, metaData);
+        spend.setVersion(ZEROCOIN_TX_VERSION_3);
+        spend.updateMetaData(coins[i], metaData);
+
+        CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
+        serialized << spend;
+        tx.vin[0].scriptSig = CScript() << OP_SIGMASPEND;
+        tx.vin[0].scriptSig.insert(tx.vin[0].scriptSig.end(), serialized.begin(), serialized.end());
+        block.vtx.push_back(tx);
+    }
+
+    for (int i = 0; i < CHECKBLOCK_MINTS; i++) {
+        sigma::PrivateCoin coin(params, denomination);
+        std::vector<unsigned char> value(coin.getPublicCoin().getValue().memoryRequired());
+        coin.getPublicCoin().getValue().serialize(value.data());
+
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(uint256S("0x02"), i);
+        CScript script = CScript() << OP_SIGMAMINT;
+        script.insert(script.end(), value.begin(), value.end());
+        tx.vout.push_back(CTxOut(denominationValue, script));
+        block.vtx.push_back(tx);
+    }
+
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+
+    while (state.KeepRunning()) {
+        // sigma information is collected anew by every check
+        block.sigmaTxInfo.reset();
+        CValidationState validationState;
+        LOCK(cs_main);
+        bool fValid = CheckBlock(block, validationState, consensus, false, true, nHeight);
+        assert(fValid);
+    }
+
+    sigmaState->Reset();
+    mapArgs.erase("-maxsigmaproofcachesize");
+}
+
+BENCHMARK(CheckBlockSigma);
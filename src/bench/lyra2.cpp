@@ -0,0 +1,75 @@
+// Copyright (c) 2019 The GravityCoin Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "crypto/Lyra2Z/Lyra2.h"
+#include "crypto/Lyra2Z/Lyra2Z.h"
+
+#include <cassert>
+#include <cstring>
+
+// Parameters of the proof of work hash, see CBlockHeader::GetPoWHash
+static const uint64_t LYRA2Z_TIME_COST = 2;
+static const uint64_t LYRA2Z_ROWS = 330;
+static const uint64_t LYRA2Z_COLS = 256;
+static const size_t HEADER_SIZE = 80;
+
+// Allocates the memory matrix for every hash
+static void LYRA2_Alloc(benchmark::State& state)
+{
+    unsigned char header[HEADER_SIZE] = {0};
+    unsigned char hash[32];
+    uint32_t nonce = 0;
+    while (state.KeepRunning()) {
+        memcpy(header + HEADER_SIZE - 4, &nonce, 4);
+        nonce++;
+        LYRA2(hash, 32, header, HEADER_SIZE, header, HEADER_SIZE, LYRA2Z_TIME_COST, LYRA2Z_ROWS, LYRA2Z_COLS);
+    }
+}
+
+// Reuses the memory matrix as validation and mining do
+static void LYRA2_Context(benchmark::State& state)
+{
+    lyra2z_ctx ctx;
+    int ret = lyra2z_ctx_init(&ctx, LYRA2Z_ROWS, LYRA2Z_COLS, 0);
+    assert(ret == 0);
+
+    unsigned char header[HEADER_SIZE] = {0};
+    unsigned char hash[32];
+    uint32_t nonce = 0;
+    while (state.KeepRunning()) {
+        memcpy(header + HEADER_SIZE - 4, &nonce, 4);
+        nonce++;
+        lyra2z_ctx_hash(&ctx, hash, 32, header, HEADER_SIZE, header, HEADER_SIZE, LYRA2Z_TIME_COST);
+    }
+
+    lyra2z_ctx_free(&ctx);
+}
+
+// One iteration hashes LYRA2_MAX_LANES nonces at once, as the built-in miner does
+static void LYRA2_Lanes(benchmark::State& state)
+{
+    lyra2z_ctx ctx[LYRA2_MAX_LANES];
+    for (unsigned int lane = 0; lane < LYRA2_MAX_LANES; lane++) {
+        int ret = lyra2z_ctx_init(&ctx[lane], LYRA2Z_ROWS, LYRA2Z_COLS, 0);
+        assert(ret == 0);
+    }
+
+    unsigned char headers[LYRA2_MAX_LANES * HEADER_SIZE] = {0};
+    unsigned char hashes[LYRA2_MAX_LANES * 32];
+    uint32_t nonce = 0;
+    while (state.KeepRunning()) {
+        for (unsigned int lane = 0; lane < LYRA2_MAX_LANES; lane++, nonce++)
+            memcpy(headers + lane * HEADER_SIZE + HEADER_SIZE - 4, &nonce, 4);
+        lyra2z_ctx_hash_lanes(ctx, LYRA2_MAX_LANES, hashes, 32, headers, HEADER_SIZE, headers, HEADER_SIZE, LYRA2Z_TIME_COST);
+    }
+
+    for (unsigned int lane = 0; lane < LYRA2_MAX_LANES; lane++)
+        lyra2z_ctx_free(&ctx[lane]);
+}
+
+BENCHMARK(LYRA2_Alloc);
+BENCHMARK(LYRA2_Context);
+BENCHMARK(LYRA2_Lanes);
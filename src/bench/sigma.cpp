@@ -0,0 +1,247 @@
+// Copyright (c) 2019 The GravityCoin Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "sigma_data.h"
+
+#include "chain.h"
+#include "sigma.h"
+#include "streams.h"
+#include "version.h"
+#include "sigma/coinspend.h"
+#include "sigma/params.h"
+#include "sigma/sigmaplus_prover.h"
+#include "sigma/sigmaplus_verifier.h"
+#include "libzerocoin/ParallelTasks.h"
+#include "utiltime.h"
+
+#include <secp256k1/include/MultiExponent.h>
+
+#include <cassert>
+#include <ctime>
+
+using namespace secp_primitives;
+
+namespace {
+
+// Proofs over a set of N commits where the one at index l opens to zero, as the
+// commits are shifted by g^-serial before proving a spend.
+struct ProofData {
+    std::vector<GroupElement> commits;
+    std::vector<Scalar> serials;
+    std::vector<std::size_t> setSizes;
+    std::vector<sigma::SigmaPlusProof<Scalar, GroupElement>> proofs;
+
+    ProofData(std::size_t N, std::size_t nProofs) {
+        const sigma::Params* params = sigma::Params::get_default();
+        sigma::SigmaPlusProver<Scalar, GroupElement> prover(
+            params->get_g(), params->get_h(), params->get_n(), params->get_m(), params->get_tables());
+
+        commits = BenchGroupElements(N);
+        std::vector<std::size_t> indices;
+        std::vector<Scalar> randomness;
+        for (std::size_t t = 0; t < nProofs; t++) {
+            indices.push_back(t * N / nProofs);
+            serials.push_back(BenchScalar(2 * t));
+            randomness.push_back(BenchScalar(2 * t + 1));
+            commits[indices[t]] = params->get_g() * serials[t] + params->get_h0() * randomness[t];
+            setSizes.push_back(N);
+        }
+
+        for (std::size_t t = 0; t < nProofs; t++) {
+            proofs.emplace_back(params->get_n(), params->get_m());
+            prover.proof(Shifted(t), indices[t], randomness[t], proofs.back());
+        }
+    }
+
+    std::vector<GroupElement> Shifted(std::size_t t) const {
+        std::vector<GroupElement> shifted(commits);
+        GroupElement gs = (sigma::Params::get_default()->get_g() * serials[t]).inverse();
+        for (GroupElement& commit : shifted)
+            commit += gs;
+        return shifted;
+    }
+};
+
+}
+
+static void SigmaProve(benchmark::State& state, std::size_t N)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    sigma::SigmaPlusProver<Scalar, GroupElement> prover(
+        params->get_g(), params->get_h(), params->get_n(), params->get_m(), params->get_tables());
+
+    std::vector<GroupElement> commits = BenchGroupElements(N);
+    Scalar r = BenchScalar(0);
+    commits[N / 2] = params->get_h0() * r;
+
+    sigma::SigmaPlusProof<Scalar, GroupElement> proof(params->get_n(), params->get_m());
+    while (state.KeepRunning()) {
+        prover.proof(commits, N / 2, r, proof);
+    }
+}
+
+static void SigmaVerify(benchmark::State& state, std::size_t N)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    sigma::SigmaPlusVerifier<Scalar, GroupElement> verifier(
+        params->get_g(), params->get_h(), params->get_n(), params->get_m(), params->get_tables());
+
+    ProofData data(N, 1);
+    std::vector<GroupElement> shifted = data.Shifted(0);
+    while (state.KeepRunning()) {
+        bool fValid = verifier.verify(shifted, data.proofs[0]);
+        assert(fValid);
+    }
+}
+
+static void SigmaBatchVerify(benchmark::State& state, std::size_t N, std::size_t nProofs)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    sigma::SigmaPlusVerifier<Scalar, GroupElement> verifier(
+        params->get_g(), params->get_h(), params->get_n(), params->get_m(), params->get_tables());
+
+    ProofData data(N, nProofs);
+    while (state.KeepRunning()) {
+        bool fValid = verifier.batch_verify(data.commits.data(), N, data.serials, data.setSizes, data.proofs);
+        assert(fValid);
+    }
+}
+
+static void MultiExponentiation(benchmark::State& state, std::size_t N)
+{
+    std::vector<GroupElement> points = BenchGroupElements(N);
+    std::vector<Scalar> exponents;
+    for (std::size_t i = 0; i < N; i++)
+        exponents.push_back(BenchScalar(i));
+
+    while (state.KeepRunning()) {
+        MultiExponent mult(points.data(), exponents.data(), N);
+        mult.get_multiple();
+    }
+}
+
+// A spend of the last coin of a 1024 coin set, as it is carried in the transaction
+static CDataStream SerializedCoinSpend()
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    sigma::PrivateCoin coin(params, sigma::CoinDenomination::SIGMA_DENOM_X1);
+
+    std::vector<sigma::PublicCoin> anonymitySet;
+    for (const GroupElement& value : BenchGroupElements(1023))
+        anonymitySet.emplace_back(value, sigma::CoinDenomination::SIGMA_DENOM_X1);
+    anonymitySet.push_back(coin.getPublicCoin());
+
+    sigma::SpendMetaData metaData(1, uint256(), uint256());
+    sigma::CoinSpend spend(params, coin, anonymitySet, metaData);
+    spend.setVersion(ZEROCOIN_TX_VERSION_3);
+
+    CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
+    serialized << spend;
+    return serialized;
+}
+
+// Creates a spend of the last coin of an N coin set on the calling thread, as the wallet does for a
+// single input, or from a task of the thread pool, as for several inputs at once. Either way the proof
+// has to keep more than one core busy.
+static void CoinSpendCreate(benchmark::State& state, std::size_t N, bool fFromPool)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    sigma::PrivateCoin coin(params, sigma::CoinDenomination::SIGMA_DENOM_X1);
+
+    std::vector<sigma::PublicCoin> anonymitySet;
+    for (const GroupElement& value : BenchGroupElements(N - 1))
+        anonymitySet.emplace_back(value, sigma::CoinDenomination::SIGMA_DENOM_X1);
+    anonymitySet.push_back(coin.getPublicCoin());
+
+    sigma::SpendMetaData metaData(1, uint256(), uint256());
+    auto createSpend = [&] { sigma::CoinSpend spend(params, coin, anonymitySet, metaData); };
+
+    int64_t nWallTime = 0;
+    std::clock_t nCpuTime = 0;
+    while (state.KeepRunning()) {
+        int64_t nWallStart = GetTimeMicros();
+        std::clock_t nCpuStart = std::clock();
+        if (fFromPool) {
+            libzerocoin::ParallelTasks tasks(1);
+            tasks.Add(createSpend);
+            tasks.Wait();
+        } else {
+            createSpend();
+        }
+        nCpuTime += std::clock() - nCpuStart;
+        nWallTime += GetTimeMicros() - nWallStart;
+    }
+
+    // process CPU time exceeds the wall time only if several threads worked on the proof
+    if (boost::thread::hardware_concurrency() > 1)
+        assert(1e6 * nCpuTime / CLOCKS_PER_SEC > 1.5 * nWallTime);
+}
+
+static void CoinSpendSerialize(benchmark::State& state)
+{
+    CDataStream serialized = SerializedCoinSpend();
+    sigma::CoinSpend spend(sigma::Params::get_default(), serialized);
+
+    while (state.KeepRunning()) {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << spend;
+    }
+}
+
+static void CoinSpendDeserialize(benchmark::State& state)
+{
+    CDataStream serialized = SerializedCoinSpend();
+
+    while (state.KeepRunning()) {
+        CDataStream stream(serialized);
+        sigma::CoinSpend spend(sigma::Params::get_default(), stream);
+    }
+}
+
+// Connects a block with 1000 mints and 100 spends to a state holding only that block
+static void SigmaStateAddBlock(benchmark::State& state)
+{
+    std::vector<GroupElement> values = BenchGroupElements(1000);
+    sigma::CSigmaBlockData blockData;
+    std::vector<sigma::PublicCoin>& mints = blockData.mints[std::make_pair(sigma::CoinDenomination::SIGMA_DENOM_X1, 1)];
+    for (const GroupElement& value : values)
+        mints.emplace_back(value, sigma::CoinDenomination::SIGMA_DENOM_X1);
+    for (uint32_t i = 0; i < 100; i++)
+        blockData.spends[BenchScalar(i)] = sigma::CSpendCoinInfo::make(sigma::CoinDenomination::SIGMA_DENOM_X1, 1);
+
+    CBlockIndex index;
+    index.nHeight = 1;
+
+    sigma::CSigmaState sigmaState;
+    while (state.KeepRunning()) {
+        sigmaState.Reset();
+        sigmaState.AddBlock(&index, blockData);
+    }
+}
+
+static void SigmaProve_1024(benchmark::State& state) { SigmaProve(state, 1024); }
+static void SigmaProve_16384(benchmark::State& state) { SigmaProve(state, 16384); }
+static void SigmaVerify_1024(benchmark::State& state) { SigmaVerify(state, 1024); }
+static void SigmaVerify_16384(benchmark::State& state) { SigmaVerify(state, 16384); }
+static void SigmaBatchVerify_10x16384(benchmark::State& state) { SigmaBatchVerify(state, 16384, 10); }
+static void CoinSpendCreate_16384(benchmark::State& state) { CoinSpendCreate(state, 16384, false); }
+static void CoinSpendCreateFromPool_16384(benchmark::State& state) { CoinSpendCreate(state, 16384, true); }
+static void MultiExponent_64(benchmark::State& state) { MultiExponentiation(state, 64); }
+static void MultiExponent_1024(benchmark::State& state) { MultiExponentiation(state, 1024); }
+static void MultiExponent_16384(benchmark::State& state) { MultiExponentiation(state, 16384); }
+
+BENCHMARK(SigmaProve_1024);
+BENCHMARK(SigmaProve_16384);
+BENCHMARK(SigmaVerify_1024);
+BENCHMARK(SigmaVerify_16384);
+BENCHMARK(SigmaBatchVerify_10x16384);
+BENCHMARK(MultiExponent_64);
+BENCHMARK(MultiExponent_1024);
+BENCHMARK(MultiExponent_16384);
+BENCHMARK(CoinSpendCreate_16384);
+BENCHMARK(CoinSpendCreateFromPool_16384);
+BENCHMARK(CoinSpendSerialize);
+BENCHMARK(CoinSpendDeserialize);
+BENCHMARK(SigmaStateAddBlock);
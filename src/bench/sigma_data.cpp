@@ -0,0 +1,40 @@
+// Copyright (c) 2019 The GravityCoin Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sigma_data.h"
+
+#include "crypto/sha256.h"
+
+static void BenchSeed(uint32_t i, unsigned char tag, unsigned char seed[CSHA256::OUTPUT_SIZE])
+{
+    unsigned char data[5] = {tag, (unsigned char)i, (unsigned char)(i >> 8), (unsigned char)(i >> 16), (unsigned char)(i >> 24)};
+    CSHA256().Write(data, sizeof(data)).Finalize(seed);
+}
+
+secp_primitives::Scalar BenchScalar(uint32_t i)
+{
+    unsigned char seed[CSHA256::OUTPUT_SIZE];
+    BenchSeed(i, 's', seed);
+    secp_primitives::Scalar result;
+    result.generate(seed);
+    return result;
+}
+
+secp_primitives::GroupElement BenchGroupElement(uint32_t i)
+{
+    unsigned char seed[CSHA256::OUTPUT_SIZE];
+    BenchSeed(i, 'g', seed);
+    secp_primitives::GroupElement result;
+    result.generate(seed);
+    return result;
+}
+
+std::vector<secp_primitives::GroupElement> BenchGroupElements(std::size_t n, uint32_t first)
+{
+    std::vector<secp_primitives::GroupElement> result;
+    result.reserve(n);
+    for (std::size_t i = 0; i < n; i++)
+        result.push_back(BenchGroupElement(first + i));
+    return result;
+}
@@ -0,0 +1,20 @@
+// Copyright (c) 2019 The GravityCoin Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GRAVITYCOIN_BENCH_SIGMA_DATA_H
+#define GRAVITYCOIN_BENCH_SIGMA_DATA_H
+
+#include <secp256k1/include/GroupElement.h>
+#include <secp256k1/include/Scalar.h>
+
+#include <cstdint>
+#include <vector>
+
+// Inputs of the sigma benchmarks are derived from their index, so every run works on the same data.
+
+secp_primitives::Scalar BenchScalar(uint32_t i);
+secp_primitives::GroupElement BenchGroupElement(uint32_t i);
+std::vector<secp_primitives::GroupElement> BenchGroupElements(std::size_t n, uint32_t first = 0);
+
+#endif // GRAVITYCOIN_BENCH_SIGMA_DATA_H
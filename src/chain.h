@@ -120,6 +120,13 @@ struct CDiskBlockPos
 
 };
 
+//! Block index entries written by this client version and later store proof of work hash of the block
+static const int POW_HASH_BLOCK_INDEX_VERSION = 4000709;
+
+//! Block index entries written by this client version and later no longer carry sigma mints and spends,
+//! these are kept in the block tree database as sigma::CSigmaBlockData
+static const int SIGMA_BLOCK_DATA_INDEX_VERSION = 4000710;
+
 enum BlockStatus: uint32_t {
     //! Unused.
     BLOCK_VALID_UNKNOWN      =    0,
@@ -210,17 +217,12 @@ public:
     unsigned int nBits;
     unsigned int nNonce;
 
+    //! Lyra2Z hash of the block header, null if not known yet. Protected by cs_main, see GetBlockPoWHash()
+    mutable uint256 powHash;
+
     //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
     uint32_t nSequenceId;
 
-/////////////////////// Sigma index entries. ////////////////////////////////////////////
-
-    //! Public coin values of mints in this block, ordered by serialized value of public coin
-    //! Maps <denomination,id> to vector of public coins
-    std::map<pair<sigma::CoinDenomination, int>, vector<sigma::PublicCoin>> sigmaMintedPubCoins;
-
-    //! Values of coin serials spent in this block
-    sigma::spend_info_container sigmaSpentSerials;
     void SetNull()
     {
         phashBlock = NULL;
@@ -241,8 +243,7 @@ public:
         nTime          = 0;
         nBits          = 0;
         nNonce         = 0;
-        sigmaMintedPubCoins.clear();
-        sigmaSpentSerials.clear();
+        powHash.SetNull();
     }
 
     CBlockIndex()
@@ -259,6 +260,8 @@ public:
         nTime          = block.nTime;
         nBits          = block.nBits;
         nNonce         = block.nNonce;
+        if (block.HasPoWHash())
+            powHash = block.GetPoWHash();
     }
 
     CDiskBlockPos GetBlockPos() const {
@@ -298,6 +301,15 @@ public:
         return *phashBlock;
     }
 
+    //! Lyra2Z hash of the header, computed on first use if it wasn't stored in the block index.
+    //! Requires cs_main, the result is kept in powHash
+    uint256 GetBlockPoWHash() const
+    {
+        if (powHash.IsNull())
+            powHash = GetBlockHeader().GetPoWHash();
+        return powHash;
+    }
+
     int64_t GetBlockTime() const
     {
         return (int64_t)nTime;
@@ -368,6 +380,8 @@ class CDiskBlockIndex : public CBlockIndex
 public:
     uint256 hashPrev;
     int nDiskBlockVersion;
+    //! Sigma mints and spends of entries written by older clients
+    sigma::CSigmaBlockData legacySigmaData;
 
     CDiskBlockIndex() {
         hashPrev = uint256();
@@ -405,8 +419,12 @@ public:
         READWRITE(nBits);
         READWRITE(nNonce);
         if (!(nType & SER_GETHASH)) {
-            READWRITE(sigmaMintedPubCoins);
-            READWRITE(sigmaSpentSerials);
+            if (nVersion < SIGMA_BLOCK_DATA_INDEX_VERSION) {
+                READWRITE(legacySigmaData.mints);
+                READWRITE(legacySigmaData.spends);
+            }
+            if (nVersion >= POW_HASH_BLOCK_INDEX_VERSION)
+                READWRITE(powHash);
         }
         nDiskBlockVersion = nVersion;
     }
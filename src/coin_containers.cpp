@@ -35,6 +35,22 @@ CMintedCoinInfo CMintedCoinInfo::make(CoinDenomination denomination,  int coinGr
     return coinInfo;
 }
 
+void CompressPublicCoinValue(const GroupElement& value, unsigned char* out) {
+    unsigned char buffer[GroupElement::serialize_size];
+    value.serialize(buffer);
+    // serialized form is x, parity of y and the infinity flag
+    out[0] = buffer[33] ? 0 : 2 + buffer[32];
+    std::memcpy(out + 1, buffer, 32);
+}
+
+void DecompressPublicCoinValue(const unsigned char* in, GroupElement& value) {
+    unsigned char buffer[GroupElement::serialize_size];
+    std::memcpy(buffer, in + 1, 32);
+    buffer[32] = in[0] & 1;
+    buffer[33] = in[0] == 0;
+    value.deserialize(buffer);
+}
+
 CSpendCoinInfo CSpendCoinInfo::make(CoinDenomination denomination,  int coinGroupId) {
     CSpendCoinInfo coinInfo;
     coinInfo.denomination = denomination;
@@ -3,8 +3,11 @@
 
 #include <secp256k1/include/Scalar.h>
 #include "sigma/coin.h"
+#include "flathashmap.h"
 
+#include <map>
 #include <unordered_map>
+#include <vector>
 
 namespace sigma {
 
@@ -51,8 +54,88 @@ struct CSpendCoinInfo {
 
 };
 
-using mint_info_container = std::unordered_map<sigma::PublicCoin, CMintedCoinInfo, sigma::CPublicCoinHash>;
-using spend_info_container = std::unordered_map<Scalar, CSpendCoinInfo, sigma::CScalarHash>;
+// Open addressing tables, they hold millions of entries and are queried for every mint and spend
+using mint_info_container = flathashmap<sigma::PublicCoin, CMintedCoinInfo, sigma::CPublicCoinHash>;
+using spend_info_container = flathashmap<Scalar, CSpendCoinInfo, sigma::CScalarHash>;
+
+// Public coin value in compressed form: 0 for the point at infinity or 2 + parity of y, followed by x
+static const size_t COMPRESSED_PUBLIC_COIN_SIZE = 33;
+
+void CompressPublicCoinValue(const GroupElement& value, unsigned char* out);
+void DecompressPublicCoinValue(const unsigned char* in, GroupElement& value);
+
+// Sigma mints and spends of a block. Kept in the block tree database apart from the block index,
+// public coins are stored compressed.
+struct CSigmaBlockData {
+    // Public coins minted in the block, maps <denomination,id> to public coins ordered by serialized value
+    std::map<std::pair<CoinDenomination, int>, std::vector<PublicCoin>> mints;
+    // Serials of coins spent in the block
+    spend_info_container spends;
+
+    bool IsEmpty() const {
+        return mints.empty() && spends.empty();
+    }
+
+    size_t GetSerializeSize(int nType, int nVersion) const {
+        size_t nSize = GetSizeOfCompactSize(mints.size());
+        for (const auto& group : mints) {
+            nSize += 1 + GetSizeOfCompactSize(group.first.second) + GetSizeOfCompactSize(group.second.size());
+            nSize += group.second.size() * COMPRESSED_PUBLIC_COIN_SIZE;
+        }
+        nSize += GetSizeOfCompactSize(spends.size());
+        for (const auto& spend : spends)
+            nSize += spend.first.memoryRequired() + 1 + GetSizeOfCompactSize(spend.second.coinGroupId);
+        return nSize;
+    }
+
+    template<typename Stream>
+    void Serialize(Stream& s, int nType, int nVersion) const {
+        unsigned char buffer[COMPRESSED_PUBLIC_COIN_SIZE];
+        WriteCompactSize(s, mints.size());
+        for (const auto& group : mints) {
+            sigma::Serialize(s, group.first.first, nType, nVersion);
+            WriteCompactSize(s, group.first.second);
+            WriteCompactSize(s, group.second.size());
+            for (const auto& coin : group.second) {
+                CompressPublicCoinValue(coin.getValue(), buffer);
+                s.write((const char*)buffer, COMPRESSED_PUBLIC_COIN_SIZE);
+            }
+        }
+        WriteCompactSize(s, spends.size());
+        for (const auto& spend : spends) {
+            ::Serialize(s, spend.first, nType, nVersion);
+            sigma::Serialize(s, spend.second.denomination, nType, nVersion);
+            WriteCompactSize(s, spend.second.coinGroupId);
+        }
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s, int nType, int nVersion) {
+        unsigned char buffer[COMPRESSED_PUBLIC_COIN_SIZE];
+        GroupElement value;
+        mints.clear();
+        spends.clear();
+        for (uint64_t nGroups = ReadCompactSize(s); nGroups > 0; nGroups--) {
+            CoinDenomination denomination;
+            sigma::Unserialize(s, denomination, nType, nVersion);
+            int coinGroupId = ReadCompactSize(s);
+            std::vector<PublicCoin>& coins = mints[std::make_pair(denomination, coinGroupId)];
+            for (uint64_t nCoins = ReadCompactSize(s); nCoins > 0; nCoins--) {
+                s.read((char*)buffer, COMPRESSED_PUBLIC_COIN_SIZE);
+                DecompressPublicCoinValue(buffer, value);
+                coins.emplace_back(value, denomination);
+            }
+        }
+        for (uint64_t nSpends = ReadCompactSize(s); nSpends > 0; nSpends--) {
+            Scalar serial;
+            CSpendCoinInfo coinInfo;
+            ::Unserialize(s, serial, nType, nVersion);
+            sigma::Unserialize(s, coinInfo.denomination, nType, nVersion);
+            coinInfo.coinGroupId = ReadCompactSize(s);
+            spends[serial] = coinInfo;
+        }
+    }
+};
 
 } // namespace sigma
 
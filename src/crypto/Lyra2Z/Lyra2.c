@@ -24,64 +24,24 @@
 #include "Lyra2.h"
 #include "Sponge.h"
 
-/**
- * Executes Lyra2 based on the G function from Blake2b. This version supports salts and passwords
- * whose combined length is smaller than the size of the memory matrix, (i.e., (nRows x nCols x b) bits,
- * where "b" is the underlying sponge's bitrate). In this implementation, the "basil" is composed by all
- * integer parameters (treated as type "unsigned int") in the order they are provided, plus the value
- * of nCols, (i.e., basil = kLen || pwdlen || saltlen || timeCost || nRows || nCols).
- *
- * @param K The derived key to be output by the algorithm
- * @param kLen Desired key length
- * @param pwd User password
- * @param pwdlen Password length
- * @param salt Salt
- * @param saltlen Salt length
- * @param timeCost Parameter to determine the processing time (T)
- * @param nRows Number or rows of the memory matrix (R)
- * @param nCols Number of columns of the memory matrix (C)
- *
- * @return 0 if the key is generated correctly; -1 if there is an error (usually due to lack of memory for allocation)
- */
-int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
-
-    //============================= Basic variables ============================//
-    int64_t row = 2; //index of row to be processed
-    int64_t prev = 1; //index of prev (last row ever computed/modified)
-    int64_t rowa = 0; //index of row* (a previous row, deterministically picked during Setup and randomly picked while Wandering)
-    int64_t tau; //Time Loop iterator
-    int64_t step = 1; //Visitation step (used during Setup and Wandering phases)
-    int64_t window = 2; //Visitation window (used to define which rows can be revisited during Setup)
-    int64_t gap = 1; //Modifier to the step, assuming the values 1 or -1
-    int64_t i; //auxiliary iteration counter
-    //==========================================================================/
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
-    //========== Initializing the Memory Matrix and pointers to it =============//
-    //Tries to allocate enough space for the whole memory matrix
-
-
-    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
-    const int64_t ROW_LEN_BYTES = ROW_LEN_INT64 * 8;
+#define LYRA2_HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
-    i = (int64_t) ((int64_t) nRows * (int64_t) ROW_LEN_BYTES);
-    uint64_t *wholeMatrix = malloc(i);
-    if (wholeMatrix == NULL) {
-      return -1;
-    }
-    memset(wholeMatrix, 0, i);
+#if defined(__GNUC__)
+#define LYRA2_PREFETCH(p) __builtin_prefetch((p))
+#else
+#define LYRA2_PREFETCH(p)
+#endif
 
-    //Allocates pointers to each row of the matrix
-    uint64_t **memMatrix = malloc(nRows * sizeof (uint64_t*));
-    if (memMatrix == NULL) {
-      return -1;
-    }
-    //Places the pointers in the correct positions
-    uint64_t *ptrWord = wholeMatrix;
-    for (i = 0; i < nRows; i++) {
-      memMatrix[i] = ptrWord;
-      ptrWord += ROW_LEN_INT64;
-    }
-    //==========================================================================/
+/**
+ * Absorbs pad(pwd || salt || basil) into the freshly initialized sponge state. The memory matrix
+ * is used to hold the padded input.
+ */
+static void LYRA2_absorbInput(uint64_t *state, uint64_t *wholeMatrix, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
+    uint64_t i; //auxiliary iteration counter
 
     //============= Getting the password + salt + basil padded with 10*1 ===============//
     //OBS.:The memory matrix will temporarily hold the password: not for saving memory,
@@ -123,28 +83,60 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
 
     //======================= Initializing the Sponge State ====================//
     //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
-    uint64_t *state = malloc(16 * sizeof (uint64_t));
-    if (state == NULL) {
-      return -1;
-    }
     initState(state);
     //==========================================================================/
 
-    //================================ Setup Phase =============================//
     //Absorbing salt, password and basil: this is the only place in which the block length is hard-coded to 512 bits
-    ptrWord = wholeMatrix;
+    uint64_t *ptrWord = wholeMatrix;
     for (i = 0; i < nBlocksInput; i++) {
       absorbBlockBlake2Safe(state, ptrWord); //absorbs each block of pad(pwd || salt || basil)
       ptrWord += BLOCK_LEN_BLAKE2_SAFE_INT64; //goes to next block of pad(pwd || salt || basil)
     }
+}
+
+/**
+ * Runs Lyra2 over already allocated memory matrices. The matrices don't need to be cleared: every row
+ * is written before it's read and the input blocks are cleared here.
+ *
+ * Computes nLanes independent hashes at once, lane l reads its password and salt at pwd + l * pwdlen and
+ * salt + l * saltlen, writes the key to K + l * kLen and uses its own matrix. The lanes are processed
+ * row by row so the memory accesses of one lane overlap with the computation of the others.
+ */
+static void LYRA2_core(unsigned int nLanes, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols, uint64_t **wholeMatrix, uint64_t ***memMatrix) {
+
+    //============================= Basic variables ============================//
+    int64_t row = 2; //index of row to be processed
+    int64_t prev = 1; //index of prev (last row ever computed/modified)
+    int64_t rowa = 0; //index of row* (a previous row, deterministically picked during Setup and randomly picked while Wandering)
+    int64_t rowaLane[LYRA2_MAX_LANES]; //row* of each lane during Wandering
+    int64_t tau; //Time Loop iterator
+    int64_t step = 1; //Visitation step (used during Setup and Wandering phases)
+    int64_t window = 2; //Visitation window (used to define which rows can be revisited during Setup)
+    int64_t gap = 1; //Modifier to the step, assuming the values 1 or -1
+    unsigned int l; //lane iterator
+    //==========================================================================/
+
+    //======================= Initializing the Sponge State ====================//
+    //Sponge state: 16 uint64_t, BLOCK_LEN_INT64 words of them for the bitrate (b) and the remainder for the capacity (c)
+    uint64_t state[LYRA2_MAX_LANES][16];
+    for (l = 0; l < nLanes; l++) {
+      LYRA2_absorbInput(state[l], wholeMatrix[l], kLen, (const byte*) pwd + l * pwdlen, pwdlen,
+          (const byte*) salt + l * saltlen, saltlen, timeCost, nRows, nCols);
+    }
+    //==========================================================================/
 
+    //================================ Setup Phase =============================//
     //Initializes M[0] and M[1]
-    reducedSqueezeRow0(state, memMatrix[0], nCols); //The locally copied password is most likely overwritten here
-    reducedDuplexRow1(state, memMatrix[0], memMatrix[1], nCols);
+    for (l = 0; l < nLanes; l++) {
+      reducedSqueezeRow0(state[l], memMatrix[l][0], nCols); //The locally copied password is most likely overwritten here
+      reducedDuplexRow1(state[l], memMatrix[l][0], memMatrix[l][1], nCols);
+    }
 
     do {
       //M[row] = rand; //M[row*] = M[row*] XOR rotW(rand)
-      reducedDuplexRowSetup(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
+      for (l = 0; l < nLanes; l++) {
+        reducedDuplexRowSetup(state[l], memMatrix[l][prev], memMatrix[l][rowa], memMatrix[l][row], nCols);
+      }
 
 
       //updates the value of row* (deterministically picked during Setup))
@@ -170,14 +162,19 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
         //Step is approximately half the number of all rows of the memory matrix for an odd tau; otherwise, it is -1
         step = (tau % 2 == 0) ? -1 : nRows / 2 - 1;
         do {
-        //Selects a pseudorandom index row*
+        //Selects a pseudorandom index row* for every lane and starts fetching it while the other lanes are processed
         //------------------------------------------------------------------------------------------
         //rowa = ((unsigned int)state[0]) & (nRows-1);	//(USE THIS IF nRows IS A POWER OF 2)
-        rowa = ((uint64_t) (state[0])) % nRows; //(USE THIS FOR THE "GENERIC" CASE)
+        for (l = 0; l < nLanes; l++) {
+          rowaLane[l] = ((uint64_t) (state[l][0])) % nRows; //(USE THIS FOR THE "GENERIC" CASE)
+          LYRA2_PREFETCH(memMatrix[l][rowaLane[l]]);
+        }
         //------------------------------------------------------------------------------------------
 
         //Performs a reduced-round duplexing operation over M[row*] XOR M[prev], updating both M[row*] and M[row]
-        reducedDuplexRow(state, memMatrix[prev], memMatrix[rowa], memMatrix[row], nCols);
+        for (l = 0; l < nLanes; l++) {
+          reducedDuplexRow(state[l], memMatrix[l][prev], memMatrix[l][rowaLane[l]], memMatrix[l][row], nCols);
+        }
 
         //update prev: it now points to the last row ever computed
         prev = row;
@@ -193,25 +190,166 @@ int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *
     //==========================================================================/
 
     //============================ Wrap-up Phase ===============================//
-    //Absorbs the last block of the memory matrix
-    absorbBlock(state, memMatrix[rowa]);
+    for (l = 0; l < nLanes; l++) {
+      //Absorbs the last block of the memory matrix
+      absorbBlock(state[l], memMatrix[l][rowaLane[l]]);
 
-    //Squeezes the key
-    squeeze(state, K, kLen);
+      //Squeezes the key
+      squeeze(state[l], (byte*) K + l * kLen, kLen);
+    }
     //==========================================================================/
 
-    //========================= Freeing the memory =============================//
+    //Wiping out the sponge's internal state
+    memset(state, 0, sizeof (state));
+}
+
+/**
+ * Releases memory allocated by LYRA2_alloc
+ */
+static void LYRA2_free(uint64_t nRows, uint64_t nCols, uint64_t *wholeMatrix, uint64_t **memMatrix, int isMapped) {
     free(memMatrix);
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (isMapped) {
+        const size_t size = (size_t) nRows * (size_t) (BLOCK_LEN_INT64 * nCols) * 8;
+        munmap(wholeMatrix, (size + LYRA2_HUGE_PAGE_SIZE - 1) & ~(size_t) (LYRA2_HUGE_PAGE_SIZE - 1));
+        return;
+    }
+#else
+    (void) nRows;
+    (void) nCols;
+    (void) isMapped;
+#endif
     free(wholeMatrix);
+}
 
-    //Wiping out the sponge's internal state before freeing it
-    memset(state, 0, 16 * sizeof (uint64_t));
-    free(state);
-    //==========================================================================/
+/**
+ * Allocates the memory matrix of nRows x nCols and the pointers to its rows.
+ *
+ * @return 0 on success; -1 if there is not enough memory
+ */
+static int LYRA2_alloc(uint64_t nRows, uint64_t nCols, uint64_t **wholeMatrix, uint64_t ***memMatrix, int useHugePages, int *isMapped) {
+    const int64_t ROW_LEN_INT64 = BLOCK_LEN_INT64 * nCols;
+    const size_t size = (size_t) nRows * (size_t) ROW_LEN_INT64 * 8;
+    uint64_t i;
+
+    *isMapped = 0;
+    *wholeMatrix = NULL;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    if (useHugePages) {
+        //Rounds the size up to the huge page size (2MB)
+        size_t mappedSize = (size + LYRA2_HUGE_PAGE_SIZE - 1) & ~(size_t) (LYRA2_HUGE_PAGE_SIZE - 1);
+        void *p = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            *wholeMatrix = (uint64_t*) p;
+            *isMapped = 1;
+        }
+    }
+#else
+    (void) useHugePages;
+#endif
+    if (*wholeMatrix == NULL) {
+        *wholeMatrix = malloc(size);
+        if (*wholeMatrix == NULL) {
+            return -1;
+        }
+        memset(*wholeMatrix, 0, size);
+    }
 
+    //Allocates pointers to each row of the matrix
+    *memMatrix = malloc(nRows * sizeof (uint64_t*));
+    if (*memMatrix == NULL) {
+        LYRA2_free(nRows, nCols, *wholeMatrix, NULL, *isMapped);
+        return -1;
+    }
+    //Places the pointers in the correct positions
+    uint64_t *ptrWord = *wholeMatrix;
+    for (i = 0; i < nRows; i++) {
+        (*memMatrix)[i] = ptrWord;
+        ptrWord += ROW_LEN_INT64;
+    }
     return 0;
 }
 
+/**
+ * Executes Lyra2 based on the G function from Blake2b. This version supports salts and passwords
+ * whose combined length is smaller than the size of the memory matrix, (i.e., (nRows x nCols x b) bits,
+ * where "b" is the underlying sponge's bitrate). In this implementation, the "basil" is composed by all
+ * integer parameters (treated as type "unsigned int") in the order they are provided, plus the value
+ * of nCols, (i.e., basil = kLen || pwdlen || saltlen || timeCost || nRows || nCols).
+ *
+ * @param K The derived key to be output by the algorithm
+ * @param kLen Desired key length
+ * @param pwd User password
+ * @param pwdlen Password length
+ * @param salt Salt
+ * @param saltlen Salt length
+ * @param timeCost Parameter to determine the processing time (T)
+ * @param nRows Number or rows of the memory matrix (R)
+ * @param nCols Number of columns of the memory matrix (C)
+ *
+ * @return 0 if the key is generated correctly; -1 if there is an error (usually due to lack of memory for allocation)
+ */
+int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
+    uint64_t *wholeMatrix;
+    uint64_t **memMatrix;
+    int isMapped;
+
+    if (LYRA2_alloc(nRows, nCols, &wholeMatrix, &memMatrix, 0, &isMapped) != 0) {
+      return -1;
+    }
+
+    LYRA2_core(1, K, kLen, pwd, pwdlen, salt, saltlen, timeCost, nRows, nCols, &wholeMatrix, &memMatrix);
+
+    LYRA2_free(nRows, nCols, wholeMatrix, memMatrix, isMapped);
+    return 0;
+}
+
+int lyra2z_ctx_init(lyra2z_ctx *ctx, uint64_t nRows, uint64_t nCols, int useHugePages) {
+    ctx->nRows = nRows;
+    ctx->nCols = nCols;
+    if (LYRA2_alloc(nRows, nCols, &ctx->wholeMatrix, &ctx->memMatrix, useHugePages, &ctx->isMapped) != 0) {
+      ctx->wholeMatrix = NULL;
+      ctx->memMatrix = NULL;
+      return -1;
+    }
+    return 0;
+}
+
+int lyra2z_ctx_hash(lyra2z_ctx *ctx, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost) {
+    if (ctx->memMatrix == NULL) {
+      return -1;
+    }
+    LYRA2_core(1, K, kLen, pwd, pwdlen, salt, saltlen, timeCost, ctx->nRows, ctx->nCols, &ctx->wholeMatrix, &ctx->memMatrix);
+    return 0;
+}
+
+int lyra2z_ctx_hash_lanes(lyra2z_ctx *ctx, unsigned int nLanes, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost) {
+    uint64_t *wholeMatrix[LYRA2_MAX_LANES];
+    uint64_t **memMatrix[LYRA2_MAX_LANES];
+    unsigned int l;
+
+    if (nLanes == 0 || nLanes > LYRA2_MAX_LANES) {
+      return -1;
+    }
+    for (l = 0; l < nLanes; l++) {
+      if (ctx[l].memMatrix == NULL || ctx[l].nRows != ctx[0].nRows || ctx[l].nCols != ctx[0].nCols) {
+        return -1;
+      }
+      wholeMatrix[l] = ctx[l].wholeMatrix;
+      memMatrix[l] = ctx[l].memMatrix;
+    }
+    LYRA2_core(nLanes, K, kLen, pwd, pwdlen, salt, saltlen, timeCost, ctx[0].nRows, ctx[0].nCols, wholeMatrix, memMatrix);
+    return 0;
+}
+
+void lyra2z_ctx_free(lyra2z_ctx *ctx) {
+    if (ctx->wholeMatrix != NULL) {
+      LYRA2_free(ctx->nRows, ctx->nCols, ctx->wholeMatrix, ctx->memMatrix, ctx->isMapped);
+    }
+    ctx->wholeMatrix = NULL;
+    ctx->memMatrix = NULL;
+}
+
 int LYRA2_old(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols) {
 
     //============================= Basic variables ============================//
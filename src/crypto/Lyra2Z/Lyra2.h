@@ -43,6 +43,37 @@ extern "C" {
 
     int LYRA2(void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost, uint64_t nRows, uint64_t nCols);
 
+    //Picks the fastest row operations which pass a self-test against the generic code (see Sponge.c), returns their name
+    const char* selectRowFunctions(void);
+
+    /**
+     * Reusable Lyra2 context: the memory matrix is allocated once by lyra2z_ctx_init and reused by
+     * every lyra2z_ctx_hash call. A context must not be used by more than one thread at a time.
+     */
+    typedef struct lyra2z_ctx {
+        uint64_t *wholeMatrix;
+        uint64_t **memMatrix;
+        uint64_t nRows;
+        uint64_t nCols;
+        int isMapped;
+    } lyra2z_ctx;
+
+    //Allocates the matrix, tries to back it with huge pages if useHugePages is set. Returns 0 on success
+    int lyra2z_ctx_init(lyra2z_ctx *ctx, uint64_t nRows, uint64_t nCols, int useHugePages);
+    //Same as LYRA2 with nRows and nCols of the context
+    int lyra2z_ctx_hash(lyra2z_ctx *ctx, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost);
+    void lyra2z_ctx_free(lyra2z_ctx *ctx);
+
+    //Maximum number of hashes computed at once by lyra2z_ctx_hash_lanes
+    #define LYRA2_MAX_LANES 8
+
+    /**
+     * Computes nLanes independent hashes at once, interleaving them row by row to hide memory latency.
+     * ctx is an array of nLanes contexts of the same size. Inputs and outputs of the lanes are stored
+     * one after another: lane l reads pwd + l * pwdlen and salt + l * saltlen and writes K + l * kLen.
+     */
+    int lyra2z_ctx_hash_lanes(lyra2z_ctx *ctx, unsigned int nLanes, void *K, uint64_t kLen, const void *pwd, uint64_t pwdlen, const void *salt, uint64_t saltlen, uint64_t timeCost);
+
 #ifdef __cplusplus
 }
 
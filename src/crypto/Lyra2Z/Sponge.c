@@ -161,7 +161,7 @@ inline void absorbBlockBlake2Safe(uint64_t *state, const uint64_t *in) {
  * @param state     The current state of the sponge
  * @param rowOut    Row to receive the data squeezed
  */
-inline void reducedSqueezeRow0(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+static inline void reducedSqueezeRow0_generic(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
     uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to M[0][C-1]
     int i;
     //M[row][C-1-col] = H.reduced_squeeze()
@@ -196,7 +196,7 @@ inline void reducedSqueezeRow0(uint64_t* state, uint64_t* rowOut, uint64_t nCols
  * @param rowIn		Row to feed the sponge
  * @param rowOut	Row to receive the sponge's output
  */
-inline void reducedDuplexRow1(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+static inline void reducedDuplexRow1_generic(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
     uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
     uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
     int i;
@@ -256,7 +256,7 @@ inline void reducedDuplexRow1(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut
  * @param rowOut         Row receiving the output
  *
  */
-inline void reducedDuplexRowSetup(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+static inline void reducedDuplexRowSetup_generic(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
     uint64_t* ptrWordIn = rowIn;				//In Lyra2: pointer to prev
     uint64_t* ptrWordInOut = rowInOut;				//In Lyra2: pointer to row*
     uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
@@ -330,7 +330,7 @@ inline void reducedDuplexRowSetup(uint64_t *state, uint64_t *rowIn, uint64_t *ro
  * @param rowOut         Row receiving the output
  *
  */
-inline void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+static inline void reducedDuplexRow_generic(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
     uint64_t* ptrWordInOut = rowInOut; //In Lyra2: pointer to row*
     uint64_t* ptrWordIn = rowIn; //In Lyra2: pointer to prev
     uint64_t* ptrWordOut = rowOut; //In Lyra2: pointer to row
@@ -391,6 +391,158 @@ inline void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOu
 }
 
 
+//Row operations: the generic code until selectRowFunctions picks a vectorized version
+typedef struct RowFunctions {
+    const char *name;
+    void (*squeezeRow0)(uint64_t* state, uint64_t* rowOut, uint64_t nCols);
+    void (*duplexRow1)(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols);
+    void (*duplexRowSetup)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+    void (*duplexRow)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+} RowFunctions;
+
+#define LYRA2_ROW_FUNCTIONS(isa) \
+    { #isa, reducedSqueezeRow0_##isa, reducedDuplexRow1_##isa, reducedDuplexRowSetup_##isa, reducedDuplexRow_##isa }
+
+static const RowFunctions rowFunctionsGeneric = LYRA2_ROW_FUNCTIONS(generic);
+static const RowFunctions *rowFunctions = &rowFunctionsGeneric;
+
+void reducedSqueezeRow0(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    rowFunctions->squeezeRow0(state, rowOut, nCols);
+}
+
+void reducedDuplexRow1(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    rowFunctions->duplexRow1(state, rowIn, rowOut, nCols);
+}
+
+void reducedDuplexRowSetup(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    rowFunctions->duplexRowSetup(state, rowIn, rowInOut, rowOut, nCols);
+}
+
+void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    rowFunctions->duplexRow(state, rowIn, rowInOut, rowOut, nCols);
+}
+
+#if defined(LYRA2_X86_DISPATCH)
+#define SELFTEST_COLS 16
+#define SELFTEST_ROWS 3
+#define SELFTEST_ROW_LEN (SELFTEST_COLS * BLOCK_LEN_INT64)
+
+typedef struct SelfTestMatrix {
+    uint64_t state[16];
+    uint64_t rows[SELFTEST_ROWS][SELFTEST_ROW_LEN];
+} SelfTestMatrix;
+
+//Fills the state and the rows with a fixed pseudo-random sequence (splitmix64)
+static void selfTestFill(SelfTestMatrix *m, uint64_t seed) {
+    uint64_t *words = m->state;
+    size_t i;
+    for (i = 0; i < sizeof(*m) / sizeof(uint64_t); i++) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        words[i] = z ^ (z >> 31);
+    }
+}
+
+/*
+ * Applies a sequence of row operations, including the aliased rows Lyra2 may pass,
+ * with the given functions to a fixed matrix.
+ */
+static void selfTestRun(const RowFunctions *f, uint64_t seed, SelfTestMatrix *m) {
+    uint64_t *state = m->state;
+    selfTestFill(m, seed);
+
+    f->squeezeRow0(state, m->rows[0], SELFTEST_COLS);
+    f->duplexRow1(state, m->rows[0], m->rows[1], SELFTEST_COLS);
+    f->duplexRowSetup(state, m->rows[1], m->rows[0], m->rows[2], SELFTEST_COLS);
+    f->duplexRowSetup(state, m->rows[2], m->rows[2], m->rows[0], SELFTEST_COLS);
+    f->duplexRow(state, m->rows[0], m->rows[1], m->rows[2], SELFTEST_COLS);
+    f->duplexRow(state, m->rows[0], m->rows[1], m->rows[1], SELFTEST_COLS);
+    f->duplexRow(state, m->rows[2], m->rows[2], m->rows[0], SELFTEST_COLS);
+    f->duplexRow(state, m->rows[1], m->rows[1], m->rows[1], SELFTEST_COLS);
+}
+
+//Genesis block header of the main network, the hash only meets the target with the right nonce
+static void selfTestHeader(unsigned char *header, uint32_t nonce) {
+    static const unsigned char merkleRoot[32] = {
+        0xdb, 0x73, 0x04, 0xa3, 0xfe, 0xc2, 0xd0, 0x17, 0xe2, 0xff, 0xb3, 0xe3, 0xa0, 0x0c, 0xd5, 0x86,
+        0x2a, 0xe7, 0x46, 0x24, 0x97, 0xa6, 0xa6, 0x85, 0x5f, 0x18, 0xa1, 0xf8, 0x23, 0x9b, 0xf4, 0x31
+    };
+    const uint32_t fields[4] = { 1485785935, 0x1f0fffff, nonce, 2 };
+    int i;
+
+    memset(header, 0, 80);
+    for (i = 0; i < 4; i++) { //little endian version, time, bits and nonce
+        header[i] = (unsigned char) (fields[3] >> (8 * i));
+        header[68 + i] = (unsigned char) (fields[0] >> (8 * i));
+        header[72 + i] = (unsigned char) (fields[1] >> (8 * i));
+        header[76 + i] = (unsigned char) (fields[2] >> (8 * i));
+    }
+    memcpy(header + 36, merkleRoot, 32);
+}
+
+/*
+ * Checks that the row functions produce the same output as the generic code, and that
+ * LYRA2 with them produces the known proof of work hashes.
+ */
+static int selfTestRowFunctions(const RowFunctions *f) {
+    static const uint32_t nonces[2] = { 2610, 0 };
+    static const unsigned char expected[2][32] = {
+        { 0xfe, 0xf5, 0x77, 0x04, 0x79, 0x3f, 0x43, 0xcf, 0xf2, 0xe3, 0x02, 0x3c, 0x1d, 0x86, 0x43, 0x5b,
+          0x73, 0xbe, 0x25, 0xcf, 0x30, 0xff, 0x95, 0xc7, 0xd6, 0x63, 0x2f, 0x50, 0x30, 0xb8, 0x08, 0x00 },
+        { 0xd2, 0x96, 0xe3, 0xb4, 0x39, 0x7d, 0xcc, 0xc6, 0x9b, 0x90, 0xf5, 0x27, 0xe9, 0x96, 0xdc, 0xf4,
+          0xa7, 0x14, 0xd4, 0xc9, 0xe3, 0x51, 0x47, 0x0c, 0xac, 0x41, 0xa4, 0xc9, 0x84, 0xe2, 0x46, 0x0e }
+    };
+    static SelfTestMatrix reference, result;
+    const RowFunctions *previous = rowFunctions;
+    unsigned char header[80], hash[32];
+    uint64_t seed;
+    int i, ok = 1;
+
+    for (seed = 1; seed <= 4 && ok; seed++) {
+        selfTestRun(&rowFunctionsGeneric, seed, &reference);
+        selfTestRun(f, seed, &result);
+        ok = memcmp(&reference, &result, sizeof(reference)) == 0;
+    }
+
+    rowFunctions = f;
+    for (i = 0; i < 2 && ok; i++) {
+        selfTestHeader(header, nonces[i]);
+        ok = LYRA2(hash, 32, header, 80, header, 80, 2, 330, 256) == 0 && memcmp(hash, expected[i], 32) == 0;
+    }
+    rowFunctions = previous;
+
+    return ok;
+}
+#endif
+
+/**
+ * Picks the vectorized row operations for the best instruction set the CPU supports,
+ * which pass the self-test, and keeps the generic code otherwise. Must be called
+ * before any other thread uses Lyra2.
+ *
+ * @return The name of the row operations in use
+ */
+const char* selectRowFunctions(void) {
+#if defined(LYRA2_X86_DISPATCH)
+    static const RowFunctions rowFunctionsAvx2 = LYRA2_ROW_FUNCTIONS(avx2);
+    static const RowFunctions rowFunctionsSsse3 = LYRA2_ROW_FUNCTIONS(ssse3);
+    static const RowFunctions rowFunctionsSse2 = LYRA2_ROW_FUNCTIONS(sse2);
+
+    const RowFunctions *selected = &rowFunctionsGeneric;
+    __builtin_cpu_init();
+    if (selected == &rowFunctionsGeneric && __builtin_cpu_supports("avx2") && selfTestRowFunctions(&rowFunctionsAvx2))
+        selected = &rowFunctionsAvx2;
+    if (selected == &rowFunctionsGeneric && __builtin_cpu_supports("ssse3") && selfTestRowFunctions(&rowFunctionsSsse3))
+        selected = &rowFunctionsSsse3;
+    if (selected == &rowFunctionsGeneric && __builtin_cpu_supports("sse2") && selfTestRowFunctions(&rowFunctionsSse2))
+        selected = &rowFunctionsSse2;
+    rowFunctions = selected;
+#endif
+    return rowFunctions->name;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
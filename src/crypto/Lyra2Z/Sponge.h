@@ -92,6 +92,22 @@ void reducedDuplexRow(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint
 //---- Misc
 void printArray(unsigned char *array, unsigned int size, char *name);
 
+//---- Vectorized row operations (Sponge_x86.c), picked at runtime by the functions above
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define LYRA2_X86_DISPATCH
+
+#define LYRA2_DECLARE_ROW_FUNCTIONS(isa) \
+    void reducedSqueezeRow0_##isa(uint64_t* state, uint64_t* row, uint64_t nCols); \
+    void reducedDuplexRow1_##isa(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols); \
+    void reducedDuplexRowSetup_##isa(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols); \
+    void reducedDuplexRow_##isa(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols);
+
+LYRA2_DECLARE_ROW_FUNCTIONS(sse2)
+LYRA2_DECLARE_ROW_FUNCTIONS(ssse3)
+LYRA2_DECLARE_ROW_FUNCTIONS(avx2)
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -0,0 +1,193 @@
+/**
+ * SSE2/SSSE3 implementation of the reduced-round duplexing operations of the sponge.
+ * This file is included by Sponge_x86.c once per instruction set, the includer defines:
+ *
+ * LYRA2_SSE_NAME(name)  name of the function for the instruction set
+ * LYRA2_SSE_TARGET      function attribute enabling the instruction set
+ * LYRA2_SSE_ROTR24(x)   64-bit rotations by 24 and 16 bits
+ * LYRA2_SSE_ROTR16(x)
+ *
+ * The sponge state is kept in registers: a0,a1 = state[0..3], b0,b1 = state[4..7],
+ * c0,c1 = state[8..11], d0,d1 = state[12..15]. Rows are accessed with unaligned loads and stores.
+ */
+
+#ifndef LYRA2_SSE_COMMON
+#define LYRA2_SSE_COMMON
+
+#define LYRA2_SSE_ROTR32(x) _mm_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define LYRA2_SSE_ROTR63(x) _mm_xor_si128(_mm_srli_epi64((x), 63), _mm_add_epi64((x), (x)))
+
+#define LYRA2_SSE_LOAD(p)     _mm_loadu_si128((const __m128i*) (p))
+#define LYRA2_SSE_STORE(p, x) _mm_storeu_si128((__m128i*) (p), (x))
+
+/*Half of Blake2b's G function applied to the four columns (or diagonals) at once*/
+#define LYRA2_SSE_G(ROTD, ROTB) \
+    a0 = _mm_add_epi64(a0, b0); a1 = _mm_add_epi64(a1, b1); \
+    d0 = _mm_xor_si128(d0, a0); d1 = _mm_xor_si128(d1, a1); \
+    d0 = ROTD(d0); d1 = ROTD(d1); \
+    c0 = _mm_add_epi64(c0, d0); c1 = _mm_add_epi64(c1, d1); \
+    b0 = _mm_xor_si128(b0, c0); b1 = _mm_xor_si128(b1, c1); \
+    b0 = ROTB(b0); b1 = ROTB(b1);
+
+#define LYRA2_SSE_DIAGONALIZE() \
+    t0 = d0; t1 = b0; \
+    d0 = c0; c0 = c1; c1 = d0; \
+    d0 = _mm_unpackhi_epi64(d1, _mm_unpacklo_epi64(t0, t0)); \
+    d1 = _mm_unpackhi_epi64(t0, _mm_unpacklo_epi64(d1, d1)); \
+    b0 = _mm_unpackhi_epi64(b0, _mm_unpacklo_epi64(b1, b1)); \
+    b1 = _mm_unpackhi_epi64(b1, _mm_unpacklo_epi64(t1, t1));
+
+#define LYRA2_SSE_UNDIAGONALIZE() \
+    t0 = c0; c0 = c1; c1 = t0; \
+    t0 = b0; t1 = d0; \
+    b0 = _mm_unpackhi_epi64(b1, _mm_unpacklo_epi64(b0, b0)); \
+    b1 = _mm_unpackhi_epi64(t0, _mm_unpacklo_epi64(b1, b1)); \
+    d0 = _mm_unpackhi_epi64(d0, _mm_unpacklo_epi64(d1, d1)); \
+    d1 = _mm_unpackhi_epi64(d1, _mm_unpacklo_epi64(t1, t1));
+
+/*One round of the Blake2b's compression function, same as ROUND_LYRA*/
+#define LYRA2_SSE_ROUND_LYRA() \
+    LYRA2_SSE_G(LYRA2_SSE_ROTR32, LYRA2_SSE_ROTR24) \
+    LYRA2_SSE_G(LYRA2_SSE_ROTR16, LYRA2_SSE_ROTR63) \
+    LYRA2_SSE_DIAGONALIZE() \
+    LYRA2_SSE_G(LYRA2_SSE_ROTR32, LYRA2_SSE_ROTR24) \
+    LYRA2_SSE_G(LYRA2_SSE_ROTR16, LYRA2_SSE_ROTR63) \
+    LYRA2_SSE_UNDIAGONALIZE()
+
+/*(hi(x), lo(y)): two words of rotW(rand)*/
+#define LYRA2_SSE_ROTW(x, y) _mm_unpacklo_epi64(_mm_unpackhi_epi64((x), (x)), (y))
+
+#define LYRA2_SSE_LOAD_STATE() \
+    a0 = LYRA2_SSE_LOAD(state + 0);  a1 = LYRA2_SSE_LOAD(state + 2); \
+    b0 = LYRA2_SSE_LOAD(state + 4);  b1 = LYRA2_SSE_LOAD(state + 6); \
+    c0 = LYRA2_SSE_LOAD(state + 8);  c1 = LYRA2_SSE_LOAD(state + 10); \
+    d0 = LYRA2_SSE_LOAD(state + 12); d1 = LYRA2_SSE_LOAD(state + 14);
+
+#define LYRA2_SSE_STORE_STATE() \
+    LYRA2_SSE_STORE(state + 0, a0);  LYRA2_SSE_STORE(state + 2, a1); \
+    LYRA2_SSE_STORE(state + 4, b0);  LYRA2_SSE_STORE(state + 6, b1); \
+    LYRA2_SSE_STORE(state + 8, c0);  LYRA2_SSE_STORE(state + 10, c1); \
+    LYRA2_SSE_STORE(state + 12, d0); LYRA2_SSE_STORE(state + 14, d1);
+
+/*state[0..11] ^= f(p), f is applied to each pair of words of the block*/
+#define LYRA2_SSE_ABSORB(f) \
+    a0 = _mm_xor_si128(a0, f(0)); a1 = _mm_xor_si128(a1, f(2)); \
+    b0 = _mm_xor_si128(b0, f(4)); b1 = _mm_xor_si128(b1, f(6)); \
+    c0 = _mm_xor_si128(c0, f(8)); c1 = _mm_xor_si128(c1, f(10));
+
+/*M[rowInOut][col] = M[rowInOut][col] XOR rotW(rand)*/
+#define LYRA2_SSE_XOR_ROTW(p) \
+    LYRA2_SSE_STORE((p) + 0,  _mm_xor_si128(LYRA2_SSE_LOAD((p) + 0),  LYRA2_SSE_ROTW(c1, a0))); \
+    LYRA2_SSE_STORE((p) + 2,  _mm_xor_si128(LYRA2_SSE_LOAD((p) + 2),  LYRA2_SSE_ROTW(a0, a1))); \
+    LYRA2_SSE_STORE((p) + 4,  _mm_xor_si128(LYRA2_SSE_LOAD((p) + 4),  LYRA2_SSE_ROTW(a1, b0))); \
+    LYRA2_SSE_STORE((p) + 6,  _mm_xor_si128(LYRA2_SSE_LOAD((p) + 6),  LYRA2_SSE_ROTW(b0, b1))); \
+    LYRA2_SSE_STORE((p) + 8,  _mm_xor_si128(LYRA2_SSE_LOAD((p) + 8),  LYRA2_SSE_ROTW(b1, c0))); \
+    LYRA2_SSE_STORE((p) + 10, _mm_xor_si128(LYRA2_SSE_LOAD((p) + 10), LYRA2_SSE_ROTW(c0, c1)));
+
+/*M[out][col] = M[in][col] XOR rand*/
+#define LYRA2_SSE_XOR_RAND(out, in) \
+    LYRA2_SSE_STORE((out) + 0,  _mm_xor_si128(LYRA2_SSE_LOAD((in) + 0),  a0)); \
+    LYRA2_SSE_STORE((out) + 2,  _mm_xor_si128(LYRA2_SSE_LOAD((in) + 2),  a1)); \
+    LYRA2_SSE_STORE((out) + 4,  _mm_xor_si128(LYRA2_SSE_LOAD((in) + 4),  b0)); \
+    LYRA2_SSE_STORE((out) + 6,  _mm_xor_si128(LYRA2_SSE_LOAD((in) + 6),  b1)); \
+    LYRA2_SSE_STORE((out) + 8,  _mm_xor_si128(LYRA2_SSE_LOAD((in) + 8),  c0)); \
+    LYRA2_SSE_STORE((out) + 10, _mm_xor_si128(LYRA2_SSE_LOAD((in) + 10), c1));
+
+#endif /* LYRA2_SSE_COMMON */
+
+LYRA2_SSE_TARGET void LYRA2_SSE_NAME(reducedSqueezeRow0)(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to M[0][C-1]
+    __m128i a0, a1, b0, b1, c0, c1, d0, d1, t0, t1;
+    uint64_t i;
+
+    LYRA2_SSE_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //M[row][C-1-col] = H.reduced_squeeze()
+        LYRA2_SSE_STORE(ptrWord + 0, a0);  LYRA2_SSE_STORE(ptrWord + 2, a1);
+        LYRA2_SSE_STORE(ptrWord + 4, b0);  LYRA2_SSE_STORE(ptrWord + 6, b1);
+        LYRA2_SSE_STORE(ptrWord + 8, c0);  LYRA2_SSE_STORE(ptrWord + 10, c1);
+        ptrWord -= BLOCK_LEN_INT64;
+
+        LYRA2_SSE_ROUND_LYRA()
+    }
+    LYRA2_SSE_STORE_STATE()
+}
+
+LYRA2_SSE_TARGET void LYRA2_SSE_NAME(reducedDuplexRow1)(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;                               //In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m128i a0, a1, b0, b1, c0, c1, d0, d1, t0, t1;
+    uint64_t i;
+
+#define LYRA2_SSE_IN(k) LYRA2_SSE_LOAD(ptrWordIn + (k))
+    LYRA2_SSE_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //Absorbing "M[prev][col]"
+        LYRA2_SSE_ABSORB(LYRA2_SSE_IN)
+        LYRA2_SSE_ROUND_LYRA()
+
+        //M[row][C-1-col] = M[prev][col] XOR rand
+        LYRA2_SSE_XOR_RAND(ptrWordOut, ptrWordIn)
+
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    LYRA2_SSE_STORE_STATE()
+#undef LYRA2_SSE_IN
+}
+
+LYRA2_SSE_TARGET void LYRA2_SSE_NAME(reducedDuplexRowSetup)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;                               //In Lyra2: pointer to prev
+    uint64_t* ptrWordInOut = rowInOut;                         //In Lyra2: pointer to row*
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m128i a0, a1, b0, b1, c0, c1, d0, d1, t0, t1;
+    uint64_t i;
+
+#define LYRA2_SSE_IN_ADD(k) _mm_add_epi64(LYRA2_SSE_LOAD(ptrWordIn + (k)), LYRA2_SSE_LOAD(ptrWordInOut + (k)))
+    LYRA2_SSE_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //Absorbing "M[prev] [+] M[row*]"
+        LYRA2_SSE_ABSORB(LYRA2_SSE_IN_ADD)
+        LYRA2_SSE_ROUND_LYRA()
+
+        //M[row][col] = M[prev][col] XOR rand
+        LYRA2_SSE_XOR_RAND(ptrWordOut, ptrWordIn)
+
+        //M[row*][col] = M[row*][col] XOR rotW(rand)
+        LYRA2_SSE_XOR_ROTW(ptrWordInOut)
+
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    LYRA2_SSE_STORE_STATE()
+#undef LYRA2_SSE_IN_ADD
+}
+
+LYRA2_SSE_TARGET void LYRA2_SSE_NAME(reducedDuplexRow)(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordInOut = rowInOut; //In Lyra2: pointer to row*
+    uint64_t* ptrWordIn = rowIn;       //In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut;     //In Lyra2: pointer to row
+    __m128i a0, a1, b0, b1, c0, c1, d0, d1, t0, t1;
+    uint64_t i;
+
+#define LYRA2_SSE_IN_ADD(k) _mm_add_epi64(LYRA2_SSE_LOAD(ptrWordIn + (k)), LYRA2_SSE_LOAD(ptrWordInOut + (k)))
+    LYRA2_SSE_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //Absorbing "M[prev] [+] M[row*]"
+        LYRA2_SSE_ABSORB(LYRA2_SSE_IN_ADD)
+        LYRA2_SSE_ROUND_LYRA()
+
+        //M[rowOut][col] = M[rowOut][col] XOR rand
+        LYRA2_SSE_XOR_RAND(ptrWordOut, ptrWordOut)
+
+        //M[rowInOut][col] = M[rowInOut][col] XOR rotW(rand), rowInOut may be the same row as rowOut
+        LYRA2_SSE_XOR_ROTW(ptrWordInOut)
+
+        ptrWordOut += BLOCK_LEN_INT64;
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+    }
+    LYRA2_SSE_STORE_STATE()
+#undef LYRA2_SSE_IN_ADD
+}
@@ -0,0 +1,191 @@
+/**
+ * SSE2, SSSE3 and AVX2 implementations of the reduced-round sponge operations used by
+ * Lyra2 on every row. Each of them produces exactly the same output as the generic code
+ * in Sponge.c, the fastest one supported by the CPU that passes the self-test is picked
+ * at startup (see selectRowFunctions in Sponge.c).
+ *
+ * Functions are compiled with the target attribute so the rest of the code doesn't need
+ * any instruction set flags.
+ */
+#include "Sponge.h"
+#include "Lyra2.h"
+
+#if defined(LYRA2_X86_DISPATCH)
+
+#include <immintrin.h>
+
+//---- SSE2: rotations by shifts
+#define LYRA2_SSE_NAME(name) name##_sse2
+#define LYRA2_SSE_TARGET __attribute__((target("sse2")))
+#define LYRA2_SSE_ROTR24(x) _mm_xor_si128(_mm_srli_epi64((x), 24), _mm_slli_epi64((x), 40))
+#define LYRA2_SSE_ROTR16(x) _mm_xor_si128(_mm_srli_epi64((x), 16), _mm_slli_epi64((x), 48))
+#include "Sponge_sse.h"
+#undef LYRA2_SSE_NAME
+#undef LYRA2_SSE_TARGET
+#undef LYRA2_SSE_ROTR24
+#undef LYRA2_SSE_ROTR16
+
+//---- SSSE3: rotations by byte shuffles
+#define LYRA2_SSE_NAME(name) name##_ssse3
+#define LYRA2_SSE_TARGET __attribute__((target("ssse3")))
+#define LYRA2_SSE_ROTR24(x) _mm_shuffle_epi8((x), _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10))
+#define LYRA2_SSE_ROTR16(x) _mm_shuffle_epi8((x), _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9))
+#include "Sponge_sse.h"
+#undef LYRA2_SSE_NAME
+#undef LYRA2_SSE_TARGET
+#undef LYRA2_SSE_ROTR24
+#undef LYRA2_SSE_ROTR16
+
+//---- AVX2: the state is kept in four registers a = state[0..3], b = state[4..7], c = state[8..11], d = state[12..15]
+#define LYRA2_AVX2_TARGET __attribute__((target("avx2")))
+
+#define LYRA2_AVX2_ROTR32(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define LYRA2_AVX2_ROTR24(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8( \
+    3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, 3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10))
+#define LYRA2_AVX2_ROTR16(x) _mm256_shuffle_epi8((x), _mm256_setr_epi8( \
+    2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, 2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9))
+#define LYRA2_AVX2_ROTR63(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define LYRA2_AVX2_LOAD(p)     _mm256_loadu_si256((const __m256i*) (p))
+#define LYRA2_AVX2_STORE(p, x) _mm256_storeu_si256((__m256i*) (p), (x))
+
+#define LYRA2_AVX2_G(ROTD, ROTB) \
+    a = _mm256_add_epi64(a, b); \
+    d = ROTD(_mm256_xor_si256(d, a)); \
+    c = _mm256_add_epi64(c, d); \
+    b = ROTB(_mm256_xor_si256(b, c));
+
+/*One round of the Blake2b's compression function, same as ROUND_LYRA*/
+#define LYRA2_AVX2_ROUND_LYRA() \
+    LYRA2_AVX2_G(LYRA2_AVX2_ROTR32, LYRA2_AVX2_ROTR24) \
+    LYRA2_AVX2_G(LYRA2_AVX2_ROTR16, LYRA2_AVX2_ROTR63) \
+    b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1)); \
+    c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2)); \
+    d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3)); \
+    LYRA2_AVX2_G(LYRA2_AVX2_ROTR32, LYRA2_AVX2_ROTR24) \
+    LYRA2_AVX2_G(LYRA2_AVX2_ROTR16, LYRA2_AVX2_ROTR63) \
+    b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3)); \
+    c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2)); \
+    d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+
+#define LYRA2_AVX2_LOAD_STATE() \
+    a = LYRA2_AVX2_LOAD(state + 0); b = LYRA2_AVX2_LOAD(state + 4); \
+    c = LYRA2_AVX2_LOAD(state + 8); d = LYRA2_AVX2_LOAD(state + 12);
+
+#define LYRA2_AVX2_STORE_STATE() \
+    LYRA2_AVX2_STORE(state + 0, a); LYRA2_AVX2_STORE(state + 4, b); \
+    LYRA2_AVX2_STORE(state + 8, c); LYRA2_AVX2_STORE(state + 12, d);
+
+/*M[out][col] = M[in][col] XOR rand*/
+#define LYRA2_AVX2_XOR_RAND(out, in) \
+    LYRA2_AVX2_STORE((out) + 0, _mm256_xor_si256(LYRA2_AVX2_LOAD((in) + 0), a)); \
+    LYRA2_AVX2_STORE((out) + 4, _mm256_xor_si256(LYRA2_AVX2_LOAD((in) + 4), b)); \
+    LYRA2_AVX2_STORE((out) + 8, _mm256_xor_si256(LYRA2_AVX2_LOAD((in) + 8), c));
+
+/*M[p][col] = M[p][col] XOR rotW(rand), rotW(rand) = (s11, s0, s1, s2), (s3, s4, s5, s6), (s7, s8, s9, s10)*/
+#define LYRA2_AVX2_XOR_ROTW(p) \
+    ra = _mm256_permute4x64_epi64(a, _MM_SHUFFLE(2, 1, 0, 3)); \
+    rb = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3)); \
+    rc = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(2, 1, 0, 3)); \
+    LYRA2_AVX2_STORE((p) + 0, _mm256_xor_si256(LYRA2_AVX2_LOAD((p) + 0), _mm256_blend_epi32(ra, rc, 0x03))); \
+    LYRA2_AVX2_STORE((p) + 4, _mm256_xor_si256(LYRA2_AVX2_LOAD((p) + 4), _mm256_blend_epi32(rb, ra, 0x03))); \
+    LYRA2_AVX2_STORE((p) + 8, _mm256_xor_si256(LYRA2_AVX2_LOAD((p) + 8), _mm256_blend_epi32(rc, rb, 0x03)));
+
+LYRA2_AVX2_TARGET void reducedSqueezeRow0_avx2(uint64_t* state, uint64_t* rowOut, uint64_t nCols) {
+    uint64_t* ptrWord = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to M[0][C-1]
+    __m256i a, b, c, d;
+    uint64_t i;
+
+    LYRA2_AVX2_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //M[row][C-1-col] = H.reduced_squeeze()
+        LYRA2_AVX2_STORE(ptrWord + 0, a);
+        LYRA2_AVX2_STORE(ptrWord + 4, b);
+        LYRA2_AVX2_STORE(ptrWord + 8, c);
+        ptrWord -= BLOCK_LEN_INT64;
+
+        LYRA2_AVX2_ROUND_LYRA()
+    }
+    LYRA2_AVX2_STORE_STATE()
+}
+
+LYRA2_AVX2_TARGET void reducedDuplexRow1_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;                               //In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m256i a, b, c, d;
+    uint64_t i;
+
+    LYRA2_AVX2_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //Absorbing "M[prev][col]"
+        a = _mm256_xor_si256(a, LYRA2_AVX2_LOAD(ptrWordIn + 0));
+        b = _mm256_xor_si256(b, LYRA2_AVX2_LOAD(ptrWordIn + 4));
+        c = _mm256_xor_si256(c, LYRA2_AVX2_LOAD(ptrWordIn + 8));
+        LYRA2_AVX2_ROUND_LYRA()
+
+        //M[row][C-1-col] = M[prev][col] XOR rand
+        LYRA2_AVX2_XOR_RAND(ptrWordOut, ptrWordIn)
+
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    LYRA2_AVX2_STORE_STATE()
+}
+
+LYRA2_AVX2_TARGET void reducedDuplexRowSetup_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordIn = rowIn;                               //In Lyra2: pointer to prev
+    uint64_t* ptrWordInOut = rowInOut;                         //In Lyra2: pointer to row*
+    uint64_t* ptrWordOut = rowOut + (nCols-1)*BLOCK_LEN_INT64; //In Lyra2: pointer to row
+    __m256i a, b, c, d, ra, rb, rc;
+    uint64_t i;
+
+    LYRA2_AVX2_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //Absorbing "M[prev] [+] M[row*]"
+        a = _mm256_xor_si256(a, _mm256_add_epi64(LYRA2_AVX2_LOAD(ptrWordIn + 0), LYRA2_AVX2_LOAD(ptrWordInOut + 0)));
+        b = _mm256_xor_si256(b, _mm256_add_epi64(LYRA2_AVX2_LOAD(ptrWordIn + 4), LYRA2_AVX2_LOAD(ptrWordInOut + 4)));
+        c = _mm256_xor_si256(c, _mm256_add_epi64(LYRA2_AVX2_LOAD(ptrWordIn + 8), LYRA2_AVX2_LOAD(ptrWordInOut + 8)));
+        LYRA2_AVX2_ROUND_LYRA()
+
+        //M[row][col] = M[prev][col] XOR rand
+        LYRA2_AVX2_XOR_RAND(ptrWordOut, ptrWordIn)
+
+        //M[row*][col] = M[row*][col] XOR rotW(rand)
+        LYRA2_AVX2_XOR_ROTW(ptrWordInOut)
+
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+        ptrWordOut -= BLOCK_LEN_INT64;
+    }
+    LYRA2_AVX2_STORE_STATE()
+}
+
+LYRA2_AVX2_TARGET void reducedDuplexRow_avx2(uint64_t *state, uint64_t *rowIn, uint64_t *rowInOut, uint64_t *rowOut, uint64_t nCols) {
+    uint64_t* ptrWordInOut = rowInOut; //In Lyra2: pointer to row*
+    uint64_t* ptrWordIn = rowIn;       //In Lyra2: pointer to prev
+    uint64_t* ptrWordOut = rowOut;     //In Lyra2: pointer to row
+    __m256i a, b, c, d, ra, rb, rc;
+    uint64_t i;
+
+    LYRA2_AVX2_LOAD_STATE()
+    for (i = 0; i < nCols; i++) {
+        //Absorbing "M[prev] [+] M[row*]"
+        a = _mm256_xor_si256(a, _mm256_add_epi64(LYRA2_AVX2_LOAD(ptrWordIn + 0), LYRA2_AVX2_LOAD(ptrWordInOut + 0)));
+        b = _mm256_xor_si256(b, _mm256_add_epi64(LYRA2_AVX2_LOAD(ptrWordIn + 4), LYRA2_AVX2_LOAD(ptrWordInOut + 4)));
+        c = _mm256_xor_si256(c, _mm256_add_epi64(LYRA2_AVX2_LOAD(ptrWordIn + 8), LYRA2_AVX2_LOAD(ptrWordInOut + 8)));
+        LYRA2_AVX2_ROUND_LYRA()
+
+        //M[rowOut][col] = M[rowOut][col] XOR rand
+        LYRA2_AVX2_XOR_RAND(ptrWordOut, ptrWordOut)
+
+        //M[rowInOut][col] = M[rowInOut][col] XOR rotW(rand), rowInOut may be the same row as rowOut
+        LYRA2_AVX2_XOR_ROTW(ptrWordInOut)
+
+        ptrWordOut += BLOCK_LEN_INT64;
+        ptrWordInOut += BLOCK_LEN_INT64;
+        ptrWordIn += BLOCK_LEN_INT64;
+    }
+    LYRA2_AVX2_STORE_STATE()
+}
+
+#endif /* LYRA2_X86_DISPATCH */
@@ -142,6 +142,13 @@ public:
         return true;
     }
 
+    //! Append the deobfuscated value to an empty stream, to deserialize it later or on another thread
+    void GetValueStream(CDataStream& ssValue) {
+        leveldb::Slice slValue = piter->value();
+        ssValue.write(slValue.data(), slValue.size());
+        ssValue.Xor(dbwrapper_private::GetObfuscateKey(parent));
+    }
+
     unsigned int GetValueSize() {
         return piter->value().size();
     }
@@ -17,13 +17,26 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <openssl/sha.h>
 
 namespace exodus
 {
+namespace {
+
+//! Consensus strings of all non-empty balance records, ordered by address and property identifier
+std::map<std::pair<std::string, uint32_t>, std::string> balanceStrings;
+
+//! Hash state after the balances were added, valid as long as no balance changed
+SHA256_CTX balancesCtx;
+bool fBalancesCtxValid = false;
+
+} // anonymous namespace
+
 bool ShouldConsensusHashBlock(int block) {
     if (exodus_debug_consensus_hash_every_block) {
         return true;
@@ -98,6 +111,41 @@ std::string GenerateConsensusString(const uint32_t propertyId, const std::string
     return strprintf("%d|%s", propertyId, address);
 }
 
+/**
+ * Updates the consensus string of a balance record.
+ *
+ * The balance records are kept in the order they are hashed in, so the consensus hash
+ * doesn't need to copy and sort the whole tally map.
+ */
+void UpdateConsensusHashBalance(const std::string& address, uint32_t propertyId)
+{
+    LOCK(cs_main);
+
+    // a record of property 0 ends the iteration of a tally, so it is never hashed
+    if (propertyId == 0) return;
+
+    fBalancesCtxValid = false;
+
+    std::pair<std::string, uint32_t> key(address, propertyId);
+    const CMPTally* tally = getTally(address);
+    std::string dataStr;
+    if (tally) dataStr = GenerateConsensusString(*tally, address, propertyId);
+
+    if (dataStr.empty()) {
+        balanceStrings.erase(key);
+    } else {
+        balanceStrings[key] = dataStr;
+    }
+}
+
+void ClearConsensusHashBalances()
+{
+    LOCK(cs_main);
+
+    balanceStrings.clear();
+    fBalancesCtxValid = false;
+}
+
 /**
  * Obtains a hash of the active state to use for consensus verification and checkpointing.
  *
@@ -157,24 +205,21 @@ uint256 GetConsensusHash()
 
     if (exodus_debug_consensus_hash) PrintToLog("Beginning generation of current consensus hash...\n");
 
-    // Balances - loop through the tally map, updating the sha context with the data from each balance and tally type
+    // Balances - loop through the balance records, updating the sha context with the data of each one
     // Placeholders:  "address|propertyid|balance|selloffer_reserve|accept_reserve|metadex_reserve"
-    // Sort alphabetically first
-    std::map<std::string, CMPTally> tallyMapSorted;
-    for (std::unordered_map<string, CMPTally>::iterator uoit = mp_tally_map.begin(); uoit != mp_tally_map.end(); ++uoit) {
-        tallyMapSorted.insert(std::make_pair(uoit->first,uoit->second));
-    }
-    for (std::map<string, CMPTally>::iterator my_it = tallyMapSorted.begin(); my_it != tallyMapSorted.end(); ++my_it) {
-        const std::string& address = my_it->first;
-        CMPTally& tally = my_it->second;
-        tally.init();
-        uint32_t propertyId = 0;
-        while (0 != (propertyId = (tally.next()))) {
-            std::string dataStr = GenerateConsensusString(tally, address, propertyId);
-            if (dataStr.empty()) continue; // skip empty balances
+    // The records are sorted alphabetically by address and then by property, and the state of the
+    // hash after the balances is reused until a balance changes
+    if (fBalancesCtxValid && !exodus_debug_consensus_hash) {
+        shaCtx = balancesCtx;
+    } else {
+        typedef std::map<std::pair<std::string, uint32_t>, std::string>::const_iterator BalanceIterator;
+        for (BalanceIterator it = balanceStrings.begin(); it != balanceStrings.end(); ++it) {
+            const std::string& dataStr = it->second;
             if (exodus_debug_consensus_hash) PrintToLog("Adding balance data to consensus hash: %s\n", dataStr);
             SHA256_Update(&shaCtx, dataStr.c_str(), dataStr.length());
         }
+        balancesCtx = shaCtx;
+        fBalancesCtxValid = true;
     }
 
     // DEx sell offers - loop through the DEx and add each sell offer to the consensus hash (ordered by txid)
@@ -318,23 +363,25 @@ uint256 GetBalancesHash(const uint32_t hashPropertyId)
 
     LOCK(cs_main);
 
-    std::map<std::string, CMPTally> tallyMapSorted;
-    for (std::unordered_map<string, CMPTally>::iterator uoit = mp_tally_map.begin(); uoit != mp_tally_map.end(); ++uoit) {
-        tallyMapSorted.insert(std::make_pair(uoit->first,uoit->second));
-    }
-    for (std::map<string, CMPTally>::iterator my_it = tallyMapSorted.begin(); my_it != tallyMapSorted.end(); ++my_it) {
-        const std::string& address = my_it->first;
-        CMPTally& tally = my_it->second;
-        tally.init();
-        uint32_t propertyId = 0;
-        while (0 != (propertyId = (tally.next()))) {
-            if (propertyId != hashPropertyId) continue;
-            std::string dataStr = GenerateConsensusString(tally, address, propertyId);
-            if (dataStr.empty()) continue;
-            if (exodus_debug_consensus_hash) PrintToLog("Adding data to balances hash: %s\n", dataStr);
-            SHA256_Update(&shaCtx, dataStr.c_str(), dataStr.length());
+    // only the holders of the property are looked at, sorted alphabetically
+    std::vector<std::string> addresses;
+    const PropertyHolders* holders = getPropertyHolders(hashPropertyId);
+    if (holders) {
+        for (std::unordered_map<std::string, int64_t>::const_iterator it = holders->tokens.begin(); it != holders->tokens.end(); ++it) {
+            addresses.push_back(it->first);
         }
     }
+    std::sort(addresses.begin(), addresses.end());
+
+    for (std::vector<std::string>::const_iterator it = addresses.begin(); it != addresses.end(); ++it) {
+        const std::string& address = *it;
+        const CMPTally* tally = getTally(address);
+        if (!tally) continue;
+        std::string dataStr = GenerateConsensusString(*tally, address, hashPropertyId);
+        if (dataStr.empty()) continue;
+        if (exodus_debug_consensus_hash) PrintToLog("Adding data to balances hash: %s\n", dataStr);
+        SHA256_Update(&shaCtx, dataStr.c_str(), dataStr.length());
+    }
 
     uint256 balancesHash;
     SHA256_Final((unsigned char*)&balancesHash, &shaCtx);
@@ -3,11 +3,20 @@
 
 #include "uint256.h"
 
+#include <stdint.h>
+#include <string>
+
 namespace exodus
 {
 /** Checks if a given block should be consensus hashed. */
 bool ShouldConsensusHashBlock(int block);
 
+/** Updates the consensus hash data of a balance record, after the tally of the address changed. */
+void UpdateConsensusHashBalance(const std::string& address, uint32_t propertyId);
+
+/** Drops the consensus hash data of all balance records, when the tallies are cleared. */
+void ClearConsensusHashBalances();
+
 /** Obtains a hash of all balances to use for consensus verification and checkpointing. */
 uint256 GetConsensusHash();
 
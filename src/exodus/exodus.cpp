@@ -12,6 +12,7 @@
 #include "packetencoder.h"
 #include "pending.h"
 #include "persistence.h"
+#include "prevouts.h"
 #include "rules.h"
 #include "script.h"
 #include "sigmadb.h"
@@ -58,7 +59,10 @@
 #include <boost/exception/to_string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
 
 #include <openssl/sha.h>
 
@@ -68,8 +72,11 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -118,6 +125,18 @@ static int64_t exodus_prev = 0;
 
 static boost::filesystem::path MPPersistencePath;
 
+//! Version of the binary state snapshots
+static const int STATE_SNAPSHOT_VERSION = 1;
+//! Number of snapshots after which a full snapshot is written instead of a delta
+static const int STATE_SNAPSHOT_BASE_INTERVAL = 10;
+
+//! Block of the last state snapshot, the next one is a full snapshot, if none
+static uint256 snapshotParent;
+//! Number of deltas written since the last full snapshot
+static int snapshotDeltas = 0;
+//! Addresses with balance changes since the last state snapshot
+static std::set<std::string> snapshotChangedAddresses;
+
 static int exodusInitialized = 0;
 
 static int reorgRecoveryMode = 0;
@@ -243,6 +262,8 @@ CrowdMap exodus::my_crowds;
 
 // this is the master list of all amounts for all addresses for all properties, map is unsorted
 std::unordered_map<std::string, CMPTally> exodus::mp_tally_map;
+// holders of every property with their tokens, allows to look at a property without walking all tallies
+std::unordered_map<uint32_t, PropertyHolders> exodus::mp_property_holders;
 
 CMPTally* exodus::getTally(const std::string& address)
 {
@@ -253,6 +274,15 @@ CMPTally* exodus::getTally(const std::string& address)
     return (CMPTally *) NULL;
 }
 
+const PropertyHolders* exodus::getPropertyHolders(uint32_t propertyId)
+{
+    std::unordered_map<uint32_t, PropertyHolders>::const_iterator it = mp_property_holders.find(propertyId);
+
+    if (it != mp_property_holders.end()) return &(it->second);
+
+    return NULL;
+}
+
 // look at balance for an address
 int64_t getMPbalance(const std::string& address, uint32_t propertyId, TallyType ttype)
 {
@@ -417,7 +447,6 @@ std::string exodus::getTokenLabel(uint32_t propertyId)
 // optionally counts the number of addresses who own that property: n_owners_total
 int64_t exodus::getTotalTokens(uint32_t propertyId, int64_t* n_owners_total)
 {
-    int64_t prev = 0;
     int64_t owners = 0;
     int64_t totalTokens = 0;
 
@@ -429,18 +458,10 @@ int64_t exodus::getTotalTokens(uint32_t propertyId, int64_t* n_owners_total)
     }
 
     if (!property.fixed || n_owners_total) {
-        for (std::unordered_map<std::string, CMPTally>::const_iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-            const CMPTally& tally = it->second;
-
-            totalTokens += tally.getMoney(propertyId, BALANCE);
-            totalTokens += tally.getMoney(propertyId, SELLOFFER_RESERVE);
-            totalTokens += tally.getMoney(propertyId, ACCEPT_RESERVE);
-            totalTokens += tally.getMoney(propertyId, METADEX_RESERVE);
-
-            if (prev != totalTokens) {
-                prev = totalTokens;
-                owners++;
-            }
+        const PropertyHolders* holders = getPropertyHolders(propertyId);
+        if (holders) {
+            totalTokens = holders->totalTokens;
+            owners = holders->owners;
         }
         int64_t cachedFee = p_feecache->GetCachedAmount(propertyId);
         totalTokens += cachedFee;
@@ -488,6 +509,18 @@ bool exodus::update_tally_map(const std::string& who, uint32_t propertyId, int64
     CMPTally& tally = my_it->second;
     bRet = tally.updateMoney(propertyId, amount, ttype);
 
+    // the tally has a record of the property now, even if the update failed
+    PropertyHolders& holders = mp_property_holders[propertyId];
+    int64_t& tokens = holders.tokens[who];
+    if (bRet && ttype != PENDING) {
+        if (tokens == 0) holders.owners++;
+        tokens += amount;
+        if (tokens == 0) holders.owners--;
+        holders.totalTokens += amount;
+        UpdateConsensusHashBalance(who, propertyId);
+        snapshotChangedAddresses.insert(who);
+    }
+
     after = getMPbalance(who, propertyId, ttype);
     if (!bRet) {
         assert(before == after);
@@ -628,26 +661,50 @@ CCoinsViewCache exodus::view(&viewDummy);
 //! Guards coins view cache
 CCriticalSection exodus::cs_tx_cache;
 
-static unsigned int nCacheHits = 0;
-static unsigned int nCacheMiss = 0;
+//! Default number of previous outputs kept by the input cache
+static const size_t DEFAULT_TX_CACHE_SIZE = 500000;
 
 /**
- * Fetches transaction inputs and adds them to the coins view cache.
+ * Returns the cache of previous outputs used to resolve transaction inputs.
  *
- * Note: cs_tx_cache should be locked, when adding and accessing inputs!
- *
- * @param tx[in]  The transaction to fetch inputs for
- * @return True, if all inputs were successfully added to the cache
+ * Note: cs_tx_cache should be locked!
  */
-static bool FillTxInputCache(const CTransaction& tx)
+static PrevoutCache& GetPrevoutCache()
 {
-    static unsigned int nCacheSize = GetArg("-exodustxcache", 500000);
+    static PrevoutCache cache(std::max((int64_t) 0, GetArg("-exodustxcache", DEFAULT_TX_CACHE_SIZE)));
+    return cache;
+}
 
-    if (view.GetCacheSize() > nCacheSize) {
-        PrintToLog("%s(): clearing cache before insertion [size=%d, hit=%d, miss=%d]\n",
-                __func__, view.GetCacheSize(), nCacheHits, nCacheMiss);
-        view.Flush();
+/**
+ * Adds the previous outputs spent by a block to the input cache, so that the
+ * inputs of its transactions are resolved without looking up their parents.
+ */
+static void CachePrevouts(const PrevoutList& prevouts)
+{
+    LOCK(cs_tx_cache);
+
+    PrevoutCache& cache = GetPrevoutCache();
+    for (PrevoutList::const_iterator it = prevouts.begin(); it != prevouts.end(); ++it) {
+        cache.Add(it->first, it->second);
     }
+}
+
+/**
+ * Fetches transaction inputs and adds them to the coins view.
+ *
+ * Inputs already available in the view, e.g. provided by the caller of an RPC, are
+ * used as they are. Other inputs are taken from the cache of previous outputs, and
+ * only looked up via their parent transaction, if they are not cached.
+ *
+ * Note: cs_tx_cache should be locked, when adding and accessing inputs!
+ *
+ * @param tx[in]       The transaction to fetch inputs for
+ * @param inputs[out]  The coins view to add the inputs to
+ * @return True, if all inputs were successfully added to the view
+ */
+static bool FillTxInputCache(const CTransaction& tx, CCoinsViewCache& inputs)
+{
+    PrevoutCache& cache = GetPrevoutCache();
 
     for (std::vector<CTxIn>::const_iterator it = tx.vin.begin(); it != tx.vin.end(); ++it) {
         const CTxIn& txIn = *it;
@@ -657,26 +714,30 @@ static bool FillTxInputCache(const CTransaction& tx)
         }
 
         unsigned int nOut = txIn.prevout.n;
-        CCoinsModifier coins = view.ModifyCoins(txIn.prevout.hash);
+        CCoinsModifier coins = inputs.ModifyCoins(txIn.prevout.hash);
 
         if (coins->IsAvailable(nOut)) {
-            ++nCacheHits;
             continue;
-        } else {
-            ++nCacheMiss;
         }
 
-        CTransaction txPrev;
-        uint256 hashBlock;
-        if (!GetTransaction(txIn.prevout.hash, txPrev, Params().GetConsensus(), hashBlock, true)) {
-            return false;
+        CTxOut txOut;
+        if (!cache.Get(txIn.prevout, txOut)) {
+            CTransaction txPrev;
+            uint256 hashBlock;
+            if (!GetTransaction(txIn.prevout.hash, txPrev, Params().GetConsensus(), hashBlock, true)) {
+                return false;
+            }
+            if (nOut >= txPrev.vout.size()) {
+                return false;
+            }
+            txOut = txPrev.vout[nOut];
+            cache.Add(txIn.prevout, txOut);
         }
 
         if (nOut >= coins->vout.size()) {
             coins->vout.resize(nOut+1);
         }
-        coins->vout[nOut].scriptPubKey = txPrev.vout[nOut].scriptPubKey;
-        coins->vout[nOut].nValue = txPrev.vout[nOut].nValue;
+        coins->vout[nOut] = txOut;
     }
 
     return true;
@@ -717,13 +778,14 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
     { // needed to ensure the cache isn't cleared in the meantime when doing parallel queries
     LOCK(cs_tx_cache);
 
-    // Add previous transaction inputs to the cache
-    if (!FillTxInputCache(wtx)) {
+    // Collect the previous transaction inputs on top of the inputs provided by the caller, if any
+    CCoinsViewCache inputs(&view);
+    if (!FillTxInputCache(wtx, inputs)) {
         PrintToLog("%s() ERROR: failed to get inputs for %s\n", __func__, wtx.GetHash().GetHex());
         return -101;
     }
 
-    assert(view.HaveInputs(wtx));
+    assert(inputs.HaveInputs(wtx));
 
     if (*exodusClass != PacketClass::C) {
         if (inputMode != InputMode::NORMAL) {
@@ -738,7 +800,7 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
             if (exodus_debug_vin) PrintToLog("vin=%d:%s\n", i, ScriptToAsmStr(wtx.vin[i].scriptSig));
 
             const CTxIn& txIn = wtx.vin[i];
-            const CTxOut& txOut = view.GetOutputFor(txIn);
+            const CTxOut& txOut = inputs.GetOutputFor(txIn);
 
             assert(!txOut.IsNull());
 
@@ -783,7 +845,7 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
         if (exodus_debug_vin) PrintToLog("vin=%d:%s\n", vin_n, ScriptToAsmStr(wtx.vin[vin_n].scriptSig));
 
         const CTxIn& txIn = wtx.vin[vin_n];
-        const CTxOut& txOut = view.GetOutputFor(txIn);
+        const CTxOut& txOut = inputs.GetOutputFor(txIn);
 
         assert(!txOut.IsNull());
 
@@ -807,7 +869,7 @@ static int parseTransaction(bool bRPConly, const CTransaction& wtx, int nBlock,
         break;
     case InputMode::NORMAL:
     default:
-        inAll = view.GetValueIn(wtx);
+        inAll = inputs.GetValueIn(wtx);
         break;
     }
 
@@ -1130,6 +1192,115 @@ public:
     }
 };
 
+//! Number of blocks the initial scan reads ahead of the block being processed
+static const int SCAN_PREFETCH_BLOCKS = 64;
+//! Maximal number of threads reading blocks for the initial scan by default
+static const int DEFAULT_SCAN_THREADS = 4;
+
+/**
+ * Reads the blocks of the initial scan ahead of their processing.
+ *
+ * Worker threads read and deserialize the blocks, mark the transactions, which may
+ * carry an Exodus packet, and collect the outputs spent by them from the undo data. The blocks are handed out strictly in order, so that the state
+ * is still updated by a single thread, one block after another.
+ */
+class CScanPrefetcher
+{
+public:
+    struct Entry
+    {
+        CBlock block;
+        bool fRead;
+        //! Whether the transaction at the same position may carry a packet
+        std::vector<bool> vMayHavePacket;
+        //! Outputs spent by the transactions, which may carry a packet
+        PrevoutList prevouts;
+    };
+
+private:
+    const std::vector<const CBlockIndex*> vBlocks;
+
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    std::map<size_t, std::shared_ptr<Entry> > mapRead;
+    size_t nNextRead;
+    size_t nNextTaken;
+    bool fStop;
+    boost::thread_group threads;
+
+    void ThreadRead()
+    {
+        RenameThread("exodus-scan");
+
+        while (true) {
+            size_t n;
+            {
+                boost::unique_lock<boost::mutex> lock(mutex);
+                while (!fStop && nNextRead < vBlocks.size() && nNextRead >= nNextTaken + SCAN_PREFETCH_BLOCKS) {
+                    cond.wait(lock);
+                }
+                if (fStop || nNextRead >= vBlocks.size()) {
+                    return;
+                }
+                n = nNextRead++;
+            }
+
+            std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+            entry->fRead = ReadBlockFromDisk(entry->block, vBlocks[n], Params().GetConsensus());
+            if (entry->fRead) {
+                entry->vMayHavePacket.reserve(entry->block.vtx.size());
+                for (std::vector<CTransaction>::const_iterator it = entry->block.vtx.begin(); it != entry->block.vtx.end(); ++it) {
+                    entry->vMayHavePacket.push_back(MayHavePacket(*it));
+                }
+                // without undo data the inputs are looked up individually
+                if (!ReadBlockPrevouts(entry->block, vBlocks[n], entry->prevouts)) {
+                    entry->prevouts.clear();
+                }
+            }
+
+            boost::unique_lock<boost::mutex> lock(mutex);
+            mapRead[n] = entry;
+            cond.notify_all();
+        }
+    }
+
+public:
+    CScanPrefetcher(const std::vector<const CBlockIndex*>& blocks, int nThreads)
+      : vBlocks(blocks), nNextRead(0), nNextTaken(0), fStop(false)
+    {
+        for (int i = 0; i < nThreads; i++) {
+            threads.create_thread(boost::bind(&CScanPrefetcher::ThreadRead, this));
+        }
+    }
+
+    ~CScanPrefetcher()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            fStop = true;
+            cond.notify_all();
+        }
+        threads.join_all();
+    }
+
+    /** Waits for the n-th block, the blocks must be taken in order. */
+    std::shared_ptr<Entry> Take(size_t n)
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        std::map<size_t, std::shared_ptr<Entry> >::iterator it;
+        while ((it = mapRead.find(n)) == mapRead.end()) {
+            cond.wait(lock);
+        }
+
+        std::shared_ptr<Entry> entry = it->second;
+        mapRead.erase(it);
+        nNextTaken = n + 1;
+        cond.notify_all();
+
+        return entry;
+    }
+};
+
 /**
  * Scans the blockchain for meta transactions.
  *
@@ -1138,6 +1309,10 @@ public:
  *
  * Every 30 seconds the progress of the scan is reported.
  *
+ * The blocks are read ahead on worker threads, and transactions without the outputs of
+ * an Exodus packet are not parsed. The inputs of the other transactions are taken from
+ * the undo data of the blocks, which is read by the worker threads as well.
+ *
  * In case the current block being processed is not part of the active chain, or
  * if a block could not be retrieved from the disk, then the scan stops early.
  * Likewise, global shutdown requests are honored, and stop the scan progress.
@@ -1164,6 +1339,15 @@ static int exodus_initial_scan(int nFirstBlock)
     // used to print the progress to the console and notifies the UI
     ProgressReporter progressReporter(chainActive[nFirstBlock], chainActive[nLastBlock]);
 
+    std::vector<const CBlockIndex*> vBlocks;
+    vBlocks.reserve(nLastBlock - nFirstBlock + 1);
+    for (nBlock = nFirstBlock; nBlock <= nLastBlock && chainActive[nBlock]; ++nBlock) {
+        vBlocks.push_back(chainActive[nBlock]);
+    }
+
+    int nThreads = std::max(1, (int) GetArg("-exodusscanthreads", std::min(GetNumCores(), DEFAULT_SCAN_THREADS)));
+    CScanPrefetcher prefetcher(vBlocks, nThreads);
+
     for (nBlock = nFirstBlock; nBlock <= nLastBlock; ++nBlock)
     {
         if (ShutdownRequested()) {
@@ -1184,9 +1368,10 @@ static int exodus_initial_scan(int nFirstBlock)
         }
 
         // Get block to parse.
-        CBlock block;
+        std::shared_ptr<CScanPrefetcher::Entry> entry = prefetcher.Take(nBlock - nFirstBlock);
+        const CBlock& block = entry->block;
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus())) {
+        if (!entry->fRead) {
             break;
         }
 
@@ -1194,8 +1379,14 @@ static int exodus_initial_scan(int nFirstBlock)
         unsigned parsed = 0;
 
         exodus_handler_block_begin(nBlock, pblockindex);
+        CachePrevouts(entry->prevouts);
 
         for (unsigned i = 0; i < block.vtx.size(); i++) {
+            if (!entry->vMayHavePacket[i]) {
+                // not an Exodus transaction, but it may still be pending
+                PendingDelete(block.vtx[i].GetHash());
+                continue;
+            }
             if (exodus_handler_tx(block.vtx[i], nBlock, i, pblockindex)) {
                 parsed++;
             }
@@ -1437,6 +1628,8 @@ static int exodus_file_load(const string &filename, int what, bool verifyHash =
   {
     case FILETYPE_BALANCES:
       mp_tally_map.clear();
+      mp_property_holders.clear();
+      ClearConsensusHashBalances();
       inputLineFunc = input_exodus_balances_string;
       break;
 
@@ -1549,10 +1742,403 @@ static char const * const statePrefix[NUM_FILETYPES] = {
     "mdexorders",
 };
 
+/**
+ * Token amounts of a balance record in a state snapshot.
+ */
+struct SnapshotBalance
+{
+    int64_t balance;
+    int64_t sellReserved;
+    int64_t acceptReserved;
+    int64_t metadexReserved;
+
+    SnapshotBalance() : balance(0), sellReserved(0), acceptReserved(0), metadexReserved(0) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(balance);
+        READWRITE(sellReserved);
+        READWRITE(acceptReserved);
+        READWRITE(metadexReserved);
+    }
+};
+
+//! Balance records of an address in a state snapshot, by property
+typedef std::map<uint32_t, SnapshotBalance> SnapshotTally;
+
+/**
+ * State of the system as of a block, as written to "state-<blockhash>.bin".
+ *
+ * A full snapshot has no parent and contains all balances. A delta only contains the
+ * addresses, which had balance changes since the parent snapshot was taken, and an
+ * address without any balance left is stored with no records. Offers, accepts, crowdsales
+ * and MetaDEx orders are few and always stored completely.
+ *
+ * The serialized snapshot is followed by its double SHA256 hash.
+ */
+struct StateSnapshot
+{
+    int nSnapshotVersion;
+    int nHeight;
+    uint256 parent;
+    std::map<std::string, SnapshotTally> balances;
+    OfferMap offers;
+    AcceptMap accepts;
+    int64_t exodusPrev;
+    uint32_t nextSPID;
+    uint32_t nextTestSPID;
+    CrowdMap crowds;
+    std::vector<CMPMetaDEx> mdexOrders;
+
+    StateSnapshot() : nSnapshotVersion(STATE_SNAPSHOT_VERSION), nHeight(0), exodusPrev(0), nextSPID(0), nextTestSPID(0) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
+        READWRITE(nSnapshotVersion);
+        READWRITE(nHeight);
+        READWRITE(parent);
+        if (nSnapshotVersion != STATE_SNAPSHOT_VERSION) {
+            throw std::ios_base::failure("unknown state snapshot version");
+        }
+        READWRITE(balances);
+        READWRITE(offers);
+        READWRITE(accepts);
+        READWRITE(exodusPrev);
+        READWRITE(nextSPID);
+        READWRITE(nextTestSPID);
+        READWRITE(crowds);
+        READWRITE(mdexOrders);
+    }
+};
+
+static boost::filesystem::path state_snapshot_path(const uint256& blockHash)
+{
+    return MPPersistencePath / strprintf("state-%s.bin", blockHash.ToString());
+}
+
+static bool is_state_prefix( std::string const &str )
+{
+  for (int i = 0; i < NUM_FILETYPES; ++i) {
+    if (boost::equals(str,  statePrefix[i])) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Removes snapshots, which are too old to be used for a reorganization, unless a newer
+ * snapshot is based on them. Legacy state files are removed, once a full snapshot exists.
+ */
+static void prune_state_files(int topHeight, bool fRemoveLegacy)
+{
+  std::map<uint256, std::pair<int, uint256> > snapshots; // block hash -> height, parent
+  std::vector<boost::filesystem::path> legacyFiles;
+
+  boost::filesystem::directory_iterator dIter(MPPersistencePath);
+  boost::filesystem::directory_iterator endIter;
+  for (; dIter != endIter; ++dIter) {
+    std::string fName = dIter->path().empty() ? "<invalid>" : (*--dIter->path().end()).string();
+    if (false == boost::filesystem::is_regular_file(dIter->status())) {
+      // skip funny business
+      PrintToLog("Non-regular file found in persistence directory : %s\n", fName);
+      continue;
+    }
+
+    std::vector<std::string> vstr;
+    boost::split(vstr, fName, boost::is_any_of("-."), token_compress_on);
+    if (vstr.size() == 3 && boost::equals(vstr[0], "state") && boost::equals(vstr[2], "bin")) {
+      uint256 blockHash;
+      blockHash.SetHex(vstr[1]);
+
+      // only the header of the snapshot is needed
+      CAutoFile file(fopen(dIter->path().string().c_str(), "rb"), SER_DISK, CLIENT_VERSION);
+      int nSnapshotVersion = 0;
+      int nHeight = 0;
+      uint256 parent;
+      try {
+        file >> nSnapshotVersion >> nHeight >> parent;
+      } catch (const std::exception& e) {
+        PrintToLog("Unreadable state snapshot found in persistence directory : %s\n", fName);
+        continue;
+      }
+      snapshots[blockHash] = std::make_pair(nHeight, parent);
+    } else if (vstr.size() == 3 && is_state_prefix(vstr[0]) && boost::equals(vstr[2], "dat")) {
+      legacyFiles.push_back(dIter->path());
+    } else {
+      PrintToLog("None state file found in persistence directory : %s\n", fName);
+    }
+  }
+
+  // keep the recent snapshots and all snapshots they are based on
+  std::set<uint256> keep;
+  std::map<uint256, std::pair<int, uint256> >::const_iterator iter;
+  for (iter = snapshots.begin(); iter != snapshots.end(); ++iter) {
+    if ((topHeight - iter->second.first) > MAX_STATE_HISTORY) continue;
+
+    uint256 blockHash = iter->first;
+    while (!blockHash.IsNull() && keep.insert(blockHash).second) {
+      std::map<uint256, std::pair<int, uint256> >::const_iterator it = snapshots.find(blockHash);
+      if (it == snapshots.end()) break;
+      blockHash = it->second.second;
+    }
+  }
+
+  for (iter = snapshots.begin(); iter != snapshots.end(); ++iter) {
+    if (keep.count(iter->first)) continue;
+
+    if (exodus_debug_persistence) {
+      PrintToLog("State from Block:%s is no longer need, removing file (age-from-tip: %d)\n", iter->first.ToString(), topHeight - iter->second.first);
+    }
+    boost::filesystem::remove(state_snapshot_path(iter->first));
+  }
+
+  if (fRemoveLegacy) {
+    for (std::vector<boost::filesystem::path>::const_iterator it = legacyFiles.begin(); it != legacyFiles.end(); ++it) {
+      boost::filesystem::remove(*it);
+    }
+  }
+}
+
+/**
+ * Writes state snapshots to disk and prunes old ones on a background thread, so the block
+ * processing only has to serialize the state.
+ */
+class CStateSnapshotWriter
+{
+private:
+    struct Job
+    {
+        boost::filesystem::path path;
+        std::vector<char> data;
+        int nHeight;
+        bool fFull;
+    };
+
+    boost::mutex mutex;
+    boost::condition_variable cond;
+    std::deque<Job> jobs;
+    bool fWriting;
+    bool fStop;
+    boost::thread thread;
+
+    void ThreadWrite()
+    {
+        RenameThread("exodus-state");
+
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while (true) {
+            while (jobs.empty() && !fStop) {
+                cond.wait(lock);
+            }
+            if (jobs.empty()) {
+                break;
+            }
+
+            Job job;
+            std::swap(job, jobs.front());
+            jobs.pop_front();
+            fWriting = true;
+            lock.unlock();
+
+            // write to a temporary file first, a snapshot file is always complete
+            boost::filesystem::path pathTmp = job.path;
+            pathTmp += ".tmp";
+            FILE* file = fopen(pathTmp.string().c_str(), "wb");
+            if (file) {
+                bool fWritten = (fwrite(job.data.data(), 1, job.data.size(), file) == job.data.size());
+                FileCommit(file);
+                fclose(file);
+                if (fWritten && RenameOver(pathTmp, job.path)) {
+                    prune_state_files(job.nHeight, job.fFull);
+                } else {
+                    PrintToLog("%s(): failed to write state snapshot %s\n", __func__, job.path.string());
+                    boost::filesystem::remove(pathTmp);
+                }
+            } else {
+                PrintToLog("%s(): failed to open %s\n", __func__, pathTmp.string());
+            }
+
+            lock.lock();
+            fWriting = false;
+            cond.notify_all();
+        }
+    }
+
+public:
+    CStateSnapshotWriter() : fWriting(false), fStop(false) {}
+
+    void Start()
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        if (thread.joinable()) return;
+        fStop = false;
+        thread = boost::thread(boost::bind(&CStateSnapshotWriter::ThreadWrite, this));
+    }
+
+    /** Writes the remaining snapshots and ends the thread. */
+    void Stop()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            fStop = true;
+            cond.notify_all();
+        }
+        if (thread.joinable()) thread.join();
+    }
+
+    void Write(const boost::filesystem::path& path, const CDataStream& ssSnapshot, int nHeight, bool fFull)
+    {
+        Job job;
+        job.path = path;
+        job.data.assign(ssSnapshot.begin(), ssSnapshot.end());
+        job.nHeight = nHeight;
+        job.fFull = fFull;
+
+        boost::unique_lock<boost::mutex> lock(mutex);
+        jobs.push_back(job);
+        cond.notify_all();
+    }
+
+    /** Waits until all queued snapshots are on disk. */
+    void Flush()
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while (!jobs.empty() || fWriting) {
+            cond.wait(lock);
+        }
+    }
+};
+
+static CStateSnapshotWriter stateSnapshotWriter;
+
+static bool read_state_snapshot(const uint256& blockHash, StateSnapshot& snapshot)
+{
+    boost::filesystem::path path = state_snapshot_path(blockHash);
+
+    try {
+        // the snapshot is mapped into memory and deserialized from there, without copying it
+        boost::interprocess::file_mapping mapping(path.string().c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+
+        const char* pbegin = static_cast<const char*>(region.get_address());
+        size_t nSize = region.get_size();
+        if (nSize < sizeof(uint256)) {
+            PrintToLog("%s(): state snapshot %s is truncated\n", __func__, path.string());
+            return false;
+        }
+        const char* pend = pbegin + nSize - sizeof(uint256);
+
+        uint256 checksum;
+        memcpy(checksum.begin(), pend, sizeof(uint256));
+        if (Hash(pbegin, pend) != checksum) {
+            PrintToLog("%s(): state snapshot %s failed hash validation!\n", __func__, path.string());
+            return false;
+        }
+
+        CByteReader ssSnapshot(pbegin, pend, SER_DISK, CLIENT_VERSION);
+        ssSnapshot >> snapshot;
+    } catch (const std::exception& e) {
+        PrintToLog("%s(): failed to read state snapshot %s: %s\n", __func__, path.string(), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Loads the state as of the given block from its snapshot and the snapshots it is based on.
+ *
+ * @param blockHash  The block of the snapshot
+ * @param nDeltas    Set to the number of deltas on top of the full snapshot
+ * @return True, if the state was loaded
+ */
+static bool load_state_snapshot(const uint256& blockHash, int& nDeltas)
+{
+    // collect the snapshots back to the full one, the newest first
+    std::vector<StateSnapshot> snapshots;
+    uint256 hash = blockHash;
+    while (true) {
+        if (snapshots.size() >= (size_t) STATE_SNAPSHOT_BASE_INTERVAL) {
+            PrintToLog("%s(): no full state snapshot found for block %s\n", __func__, blockHash.ToString());
+            return false;
+        }
+        snapshots.push_back(StateSnapshot());
+        if (!read_state_snapshot(hash, snapshots.back())) {
+            return false;
+        }
+        if (snapshots.back().parent.IsNull()) {
+            break;
+        }
+        hash = snapshots.back().parent;
+    }
+
+    // apply the balance changes of the deltas, starting with the oldest one
+    std::map<std::string, SnapshotTally> balances;
+    balances.swap(snapshots.back().balances);
+    for (std::vector<StateSnapshot>::reverse_iterator it = snapshots.rbegin() + 1; it != snapshots.rend(); ++it) {
+        std::map<std::string, SnapshotTally>::iterator iter;
+        for (iter = it->balances.begin(); iter != it->balances.end(); ++iter) {
+            if (iter->second.empty()) {
+                balances.erase(iter->first);
+            } else {
+                balances[iter->first].swap(iter->second);
+            }
+        }
+    }
+
+    mp_tally_map.clear();
+    mp_property_holders.clear();
+    ClearConsensusHashBalances();
+
+    std::map<std::string, SnapshotTally>::const_iterator iter;
+    for (iter = balances.begin(); iter != balances.end(); ++iter) {
+        const std::string& strAddress = iter->first;
+        for (SnapshotTally::const_iterator it = iter->second.begin(); it != iter->second.end(); ++it) {
+            uint32_t propertyId = it->first;
+            const SnapshotBalance& record = it->second;
+            if (record.balance) update_tally_map(strAddress, propertyId, record.balance, BALANCE);
+            if (record.sellReserved) update_tally_map(strAddress, propertyId, record.sellReserved, SELLOFFER_RESERVE);
+            if (record.acceptReserved) update_tally_map(strAddress, propertyId, record.acceptReserved, ACCEPT_RESERVE);
+            if (record.metadexReserved) update_tally_map(strAddress, propertyId, record.metadexReserved, METADEX_RESERVE);
+        }
+    }
+
+    // the other parts of the state are complete in every snapshot
+    StateSnapshot& snapshot = snapshots.front();
+    my_offers.swap(snapshot.offers);
+    my_accepts.swap(snapshot.accepts);
+    exodus_prev = snapshot.exodusPrev;
+    _my_sps->init(snapshot.nextSPID, snapshot.nextTestSPID);
+    my_crowds.swap(snapshot.crowds);
+
+    metadex.clear();
+    for (std::vector<CMPMetaDEx>::const_iterator it = snapshot.mdexOrders.begin(); it != snapshot.mdexOrders.end(); ++it) {
+        if (!MetaDEx_INSERT(*it)) {
+            PrintToLog("%s(): failed to insert MetaDEx order %s\n", __func__, it->getHash().GetHex());
+            return false;
+        }
+    }
+
+    nDeltas = snapshots.size() - 1;
+
+    PrintToLog("%s(): loaded state of block %s, %d addresses, %d deltas\n", __func__, blockHash.ToString(), balances.size(), nDeltas);
+
+    return true;
+}
+
 // returns the height of the state loaded
 static int load_most_relevant_state()
 {
   int res = -1;
+
+  // snapshots of recent blocks may still be being written
+  stateSnapshotWriter.Flush();
   // check the SP database and roll it back to its latest valid state
   // according to the active chain
   uint256 spWatermark;
@@ -1584,6 +2170,7 @@ static int load_most_relevant_state()
   // prepare a set of available files by block hash pruning any that are
   // not in the active chain
   std::set<uint256> persistedBlocks;
+  std::set<uint256> snapshotBlocks;
   boost::filesystem::directory_iterator dIter(MPPersistencePath);
   boost::filesystem::directory_iterator endIter;
   for (; dIter != endIter; ++dIter) {
@@ -1596,7 +2183,7 @@ static int load_most_relevant_state()
     std::vector<std::string> vstr;
     boost::split(vstr, fName, boost::is_any_of("-."), token_compress_on);
     if (  vstr.size() == 3 &&
-          boost::equals(vstr[2], "dat")) {
+          (boost::equals(vstr[2], "dat") || boost::equals(vstr[2], "bin"))) {
       uint256 blockHash;
       blockHash.SetHex(vstr[1]);
       CBlockIndex *pBlockIndex = GetBlockIndex(blockHash);
@@ -1606,6 +2193,9 @@ static int load_most_relevant_state()
 
       // this is a valid block in the active chain, store it
       persistedBlocks.insert(blockHash);
+      if (boost::equals(vstr[2], "bin")) {
+        snapshotBlocks.insert(blockHash);
+      }
     }
   }
 
@@ -1617,7 +2207,18 @@ static int load_most_relevant_state()
   int abortRollBackBlock;
   if (curTip != NULL) abortRollBackBlock = curTip->nHeight - (MAX_STATE_HISTORY+1);
   while (NULL != curTip && persistedBlocks.size() > 0 && curTip->nHeight > abortRollBackBlock) {
-    if (persistedBlocks.find(spBlockIndex->GetBlockHash()) != persistedBlocks.end()) {
+    if (persistedBlocks.find(curTip->GetBlockHash()) != persistedBlocks.end()) {
+      int nDeltas = 0;
+      if (snapshotBlocks.count(curTip->GetBlockHash()) && load_state_snapshot(curTip->GetBlockHash(), nDeltas)) {
+        // the next snapshot can be a delta to this one
+        snapshotParent = curTip->GetBlockHash();
+        snapshotDeltas = nDeltas;
+        snapshotChangedAddresses.clear();
+        res = curTip->nHeight;
+        break;
+      }
+
+      // fall back to the text state files of earlier versions
       int success = -1;
       for (int i = 0; i < NUM_FILETYPES; ++i) {
         boost::filesystem::path path = MPPersistencePath / strprintf("%s-%s.dat", statePrefix[i], curTip->GetBlockHash().ToString());
@@ -1629,12 +2230,14 @@ static int load_most_relevant_state()
       }
 
       if (success >= 0) {
+        snapshotParent.SetNull();
+        snapshotChangedAddresses.clear();
         res = curTip->nHeight;
         break;
       }
 
       // remove this from the persistedBlock Set
-      persistedBlocks.erase(spBlockIndex->GetBlockHash());
+      persistedBlocks.erase(curTip->GetBlockHash());
     }
 
     // go to the previous block
@@ -1657,259 +2260,85 @@ static int load_most_relevant_state()
   return res;
 }
 
-static int write_exodus_balances(std::ofstream& file, SHA256_CTX* shaCtx)
+static SnapshotTally make_snapshot_tally(CMPTally& tally)
 {
-    std::unordered_map<std::string, CMPTally>::iterator iter;
-    for (iter = mp_tally_map.begin(); iter != mp_tally_map.end(); ++iter) {
-        bool emptyWallet = true;
-
-        std::string lineOut = (*iter).first;
-        lineOut.append("=");
-        CMPTally& curAddr = (*iter).second;
-        curAddr.init();
-        uint32_t propertyId = 0;
-        while (0 != (propertyId = curAddr.next())) {
-            int64_t balance = (*iter).second.getMoney(propertyId, BALANCE);
-            int64_t sellReserved = (*iter).second.getMoney(propertyId, SELLOFFER_RESERVE);
-            int64_t acceptReserved = (*iter).second.getMoney(propertyId, ACCEPT_RESERVE);
-            int64_t metadexReserved = (*iter).second.getMoney(propertyId, METADEX_RESERVE);
-
-            // we don't allow 0 balances to read in, so if we don't write them
-            // it makes things match up better between persisted state and processed state
-            if (0 == balance && 0 == sellReserved && 0 == acceptReserved && 0 == metadexReserved) {
-                continue;
-            }
-
-            emptyWallet = false;
-
-            lineOut.append(strprintf("%d:%d,%d,%d,%d;",
-                    propertyId,
-                    balance,
-                    sellReserved,
-                    acceptReserved,
-                    metadexReserved));
-        }
-
-        if (false == emptyWallet) {
-            // add the line to the hash
-            SHA256_Update(shaCtx, lineOut.c_str(), lineOut.length());
-
-            // write the line
-            file << lineOut << endl;
+    SnapshotTally snapshotTally;
+    tally.init();
+    uint32_t propertyId = 0;
+    while (0 != (propertyId = tally.next())) {
+        SnapshotBalance record;
+        record.balance = tally.getMoney(propertyId, BALANCE);
+        record.sellReserved = tally.getMoney(propertyId, SELLOFFER_RESERVE);
+        record.acceptReserved = tally.getMoney(propertyId, ACCEPT_RESERVE);
+        record.metadexReserved = tally.getMoney(propertyId, METADEX_RESERVE);
+
+        // we don't allow 0 balances to read in, so if we don't write them
+        // it makes things match up better between persisted state and processed state
+        if (0 == record.balance && 0 == record.sellReserved && 0 == record.acceptReserved && 0 == record.metadexReserved) {
+            continue;
         }
-    }
-
-    return 0;
-}
-
-static int write_mp_offers(ofstream &file, SHA256_CTX *shaCtx)
-{
-  OfferMap::const_iterator iter;
-  for (iter = my_offers.begin(); iter != my_offers.end(); ++iter) {
-    // decompose the key for address
-    std::vector<std::string> vstr;
-    boost::split(vstr, (*iter).first, boost::is_any_of("-"), token_compress_on);
-    CMPOffer const &offer = (*iter).second;
-    offer.saveOffer(file, shaCtx, vstr[0]);
-  }
-
-
-  return 0;
-}
-
-static int write_mp_metadex(ofstream &file, SHA256_CTX *shaCtx)
-{
-  for (md_PropertiesMap::iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it)
-  {
-    md_PricesMap & prices = my_it->second;
-    for (md_PricesMap::iterator it = prices.begin(); it != prices.end(); ++it)
-    {
-      md_Set & indexes = (it->second);
-      for (md_Set::iterator it = indexes.begin(); it != indexes.end(); ++it)
-      {
-        CMPMetaDEx meta = *it;
-        meta.saveOffer(file, shaCtx);
-      }
-    }
-  }
-
-  return 0;
-}
 
-static int write_mp_accepts(ofstream &file, SHA256_CTX *shaCtx)
-{
-  AcceptMap::const_iterator iter;
-  for (iter = my_accepts.begin(); iter != my_accepts.end(); ++iter) {
-    // decompose the key for address
-    std::vector<std::string> vstr;
-    boost::split(vstr, (*iter).first, boost::is_any_of("-+"), token_compress_on);
-    CMPAccept const &accept = (*iter).second;
-    accept.saveAccept(file, shaCtx, vstr[0], vstr[1]);
-  }
-
-  return 0;
-}
-
-static int write_globals_state(ofstream &file, SHA256_CTX *shaCtx)
-{
-  unsigned int nextSPID = _my_sps->peekNextSPID(EXODUS_PROPERTY_EXODUS);
-  unsigned int nextTestSPID = _my_sps->peekNextSPID(EXODUS_PROPERTY_TEXODUS);
-  std::string lineOut = strprintf("%d,%d,%d",
-    exodus_prev,
-    nextSPID,
-    nextTestSPID);
-
-  // add the line to the hash
-  SHA256_Update(shaCtx, lineOut.c_str(), lineOut.length());
-
-  // write the line
-  file << lineOut << endl;
-
-  return 0;
-}
-
-static int write_mp_crowdsales(std::ofstream& file, SHA256_CTX* shaCtx)
-{
-    for (CrowdMap::const_iterator it = my_crowds.begin(); it != my_crowds.end(); ++it) {
-        // decompose the key for address
-        const CMPCrowd& crowd = it->second;
-        crowd.saveCrowdSale(file, shaCtx, it->first);
+        snapshotTally.insert(std::make_pair(propertyId, record));
     }
 
-    return 0;
+    return snapshotTally;
 }
 
-static int write_state_file( CBlockIndex const *pBlockIndex, int what )
-{
-  boost::filesystem::path path = MPPersistencePath / strprintf("%s-%s.dat", statePrefix[what], pBlockIndex->GetBlockHash().ToString());
-  const std::string strFile = path.string();
-
-  std::ofstream file;
-  file.open(strFile.c_str());
-
-  SHA256_CTX shaCtx;
-  SHA256_Init(&shaCtx);
-
-  int result = 0;
-
-  switch(what) {
-  case FILETYPE_BALANCES:
-    result = write_exodus_balances(file, &shaCtx);
-    break;
-
-  case FILETYPE_OFFERS:
-    result = write_mp_offers(file, &shaCtx);
-    break;
-
-  case FILETYPE_ACCEPTS:
-    result = write_mp_accepts(file, &shaCtx);
-    break;
-
-  case FILETYPE_GLOBALS:
-    result = write_globals_state(file, &shaCtx);
-    break;
-
-  case FILETYPE_CROWDSALES:
-      result = write_mp_crowdsales(file, &shaCtx);
-      break;
-
-  case FILETYPE_MDEXORDERS:
-      result = write_mp_metadex(file, &shaCtx);
-      break;
-  }
-
-  // generate and wite the double hash of all the contents written
-  uint256 hash1;
-  SHA256_Final((unsigned char*)&hash1, &shaCtx);
-  uint256 hash2;
-  SHA256((unsigned char*)&hash1, sizeof(hash1), (unsigned char*)&hash2);
-  file << "!" << hash2.ToString() << endl;
-
-  file.flush();
-  file.close();
-  return result;
-}
-
-static bool is_state_prefix( std::string const &str )
+int exodus_save_state( CBlockIndex const *pBlockIndex )
 {
-  for (int i = 0; i < NUM_FILETYPES; ++i) {
-    if (boost::equals(str,  statePrefix[i])) {
-      return true;
-    }
-  }
+    const uint256& blockHash = pBlockIndex->GetBlockHash();
 
-  return false;
-}
+    // write the new state as of the given block, as delta to the last snapshot if possible
+    bool fFull = snapshotParent.IsNull() || snapshotParent == blockHash || (snapshotDeltas + 1) >= STATE_SNAPSHOT_BASE_INTERVAL;
 
-static void prune_state_files( CBlockIndex const *topIndex )
-{
-  // build a set of blockHashes for which we have any state files
-  std::set<uint256> statefulBlockHashes;
+    StateSnapshot snapshot;
+    snapshot.nHeight = pBlockIndex->nHeight;
 
-  boost::filesystem::directory_iterator dIter(MPPersistencePath);
-  boost::filesystem::directory_iterator endIter;
-  for (; dIter != endIter; ++dIter) {
-    std::string fName = dIter->path().empty() ? "<invalid>" : (*--dIter->path().end()).string();
-    if (false == boost::filesystem::is_regular_file(dIter->status())) {
-      // skip funny business
-      PrintToLog("Non-regular file found in persistence directory : %s\n", fName);
-      continue;
-    }
-
-    std::vector<std::string> vstr;
-    boost::split(vstr, fName, boost::is_any_of("-."), token_compress_on);
-    if (  vstr.size() == 3 &&
-          is_state_prefix(vstr[0]) &&
-          boost::equals(vstr[2], "dat")) {
-      uint256 blockHash;
-      blockHash.SetHex(vstr[1]);
-      statefulBlockHashes.insert(blockHash);
+    if (fFull) {
+        std::unordered_map<std::string, CMPTally>::iterator iter;
+        for (iter = mp_tally_map.begin(); iter != mp_tally_map.end(); ++iter) {
+            SnapshotTally snapshotTally = make_snapshot_tally(iter->second);
+            if (!snapshotTally.empty()) {
+                snapshot.balances[iter->first].swap(snapshotTally);
+            }
+        }
     } else {
-      PrintToLog("None state file found in persistence directory : %s\n", fName);
+        snapshot.parent = snapshotParent;
+        std::set<std::string>::const_iterator iter;
+        for (iter = snapshotChangedAddresses.begin(); iter != snapshotChangedAddresses.end(); ++iter) {
+            SnapshotTally& snapshotTally = snapshot.balances[*iter];
+            CMPTally* tally = getTally(*iter);
+            if (tally) snapshotTally = make_snapshot_tally(*tally);
+        }
     }
-  }
 
-  // for each blockHash in the set, determine the distance from the given block
-  std::set<uint256>::const_iterator iter;
-  for (iter = statefulBlockHashes.begin(); iter != statefulBlockHashes.end(); ++iter) {
-    // look up the CBlockIndex for height info
-    CBlockIndex const *curIndex = GetBlockIndex(*iter);
-
-    // if we have nothing int the index, or this block is too old..
-    if (NULL == curIndex || (topIndex->nHeight - curIndex->nHeight) > MAX_STATE_HISTORY ) {
-     if (exodus_debug_persistence)
-     {
-      if (curIndex) {
-        PrintToLog("State from Block:%s is no longer need, removing files (age-from-tip: %d)\n", (*iter).ToString(), topIndex->nHeight - curIndex->nHeight);
-      } else {
-        PrintToLog("State from Block:%s is no longer need, removing files (not in index)\n", (*iter).ToString());
-      }
-     }
-
-      // destroy the associated files!
-      std::string strBlockHash = iter->ToString();
-      for (int i = 0; i < NUM_FILETYPES; ++i) {
-        boost::filesystem::path path = MPPersistencePath / strprintf("%s-%s.dat", statePrefix[i], strBlockHash);
-        boost::filesystem::remove(path);
-      }
+    snapshot.offers = my_offers;
+    snapshot.accepts = my_accepts;
+    snapshot.exodusPrev = exodus_prev;
+    snapshot.nextSPID = _my_sps->peekNextSPID(EXODUS_PROPERTY_EXODUS);
+    snapshot.nextTestSPID = _my_sps->peekNextSPID(EXODUS_PROPERTY_TEXODUS);
+    snapshot.crowds = my_crowds;
+    for (md_PropertiesMap::const_iterator my_it = metadex.begin(); my_it != metadex.end(); ++my_it) {
+        const md_PricesMap& prices = my_it->second;
+        for (md_PricesMap::const_iterator it = prices.begin(); it != prices.end(); ++it) {
+            const md_Set& indexes = it->second;
+            snapshot.mdexOrders.insert(snapshot.mdexOrders.end(), indexes.begin(), indexes.end());
+        }
     }
-  }
-}
 
-int exodus_save_state( CBlockIndex const *pBlockIndex )
-{
-    // write the new state as of the given block
-    write_state_file(pBlockIndex, FILETYPE_BALANCES);
-    write_state_file(pBlockIndex, FILETYPE_OFFERS);
-    write_state_file(pBlockIndex, FILETYPE_ACCEPTS);
-    write_state_file(pBlockIndex, FILETYPE_GLOBALS);
-    write_state_file(pBlockIndex, FILETYPE_CROWDSALES);
-    write_state_file(pBlockIndex, FILETYPE_MDEXORDERS);
+    CDataStream ssSnapshot(SER_DISK, CLIENT_VERSION);
+    ssSnapshot << snapshot;
+    uint256 checksum = Hash(ssSnapshot.begin(), ssSnapshot.end());
+    ssSnapshot << checksum;
 
-    // clean-up the directory
-    prune_state_files(pBlockIndex);
+    // the file is written and the directory cleaned up in the background
+    stateSnapshotWriter.Write(state_snapshot_path(blockHash), ssSnapshot, pBlockIndex->nHeight, fFull);
 
-    _my_sps->setWatermark(pBlockIndex->GetBlockHash());
+    snapshotParent = blockHash;
+    snapshotDeltas = fFull ? 0 : snapshotDeltas + 1;
+    snapshotChangedAddresses.clear();
+
+    _my_sps->setWatermark(blockHash);
 
     return 0;
 }
@@ -1923,6 +2352,10 @@ void clear_all_state()
 
     // Memory based storage
     mp_tally_map.clear();
+    mp_property_holders.clear();
+    ClearConsensusHashBalances();
+    snapshotParent.SetNull();
+    snapshotChangedAddresses.clear();
     my_offers.clear();
     my_accepts.clear();
     my_crowds.clear();
@@ -2019,6 +2452,7 @@ int exodus_init()
 
     MPPersistencePath = GetDataDir() / "MP_persist";
     TryCreateDirectory(MPPersistencePath);
+    stateSnapshotWriter.Start();
 
     txProcessor = new TxProcessor();
 
@@ -2119,6 +2553,15 @@ int exodus_shutdown()
 {
     LOCK(cs_main);
 
+    // write the remaining state snapshots
+    stateSnapshotWriter.Stop();
+
+    {
+        LOCK(cs_tx_cache);
+        PrevoutCache& cache = GetPrevoutCache();
+        PrintToLog("Input cache usage [size=%d, hit=%d, miss=%d]\n", cache.Size(), cache.Hits(), cache.Misses());
+    }
+
 #ifdef ENABLE_WALLET
     delete wallet; wallet = nullptr;
 #endif
@@ -3700,7 +4143,7 @@ int validity = 0;
   return true;
 }
 
-int exodus_handler_block_begin(int nBlockPrev, CBlockIndex const * pBlockIndex)
+int exodus_handler_block_begin(int nBlockPrev, CBlockIndex const * pBlockIndex, const CBlock* pBlock)
 {
     LOCK(cs_main);
 
@@ -3750,6 +4193,15 @@ int exodus_handler_block_begin(int nBlockPrev, CBlockIndex const * pBlockIndex)
 
     eraseExpiredCrowdsale(pBlockIndex);
 
+    // resolve the inputs of the block's transactions from its undo data
+    if (pBlock) {
+        PrevoutList prevouts;
+        if (!ReadBlockPrevouts(*pBlock, pBlockIndex, prevouts)) {
+            PrintToLog("%s(): no undo data for block %s, inputs are looked up individually\n", __func__, pBlockIndex->GetBlockHash().GetHex());
+        }
+        CachePrevouts(prevouts);
+    }
+
     return 0;
 }
 
@@ -3809,6 +4261,7 @@ int exodus_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex,
         PrintToLog(msg);
         if (!GetBoolArg("-overrideforcedshutdown", false)) {
             boost::filesystem::path persistPath = GetDataDir() / "MP_persist";
+            stateSnapshotWriter.Flush();
             if (boost::filesystem::exists(persistPath)) boost::filesystem::remove_all(persistPath); // prevent the node being restarted without a reparse after forced shutdown
             AbortNode(msg, msg);
         }
@@ -1,6 +1,7 @@
 #ifndef GRAVITYCOIN_EXODUS_EXODUS_H
 #define GRAVITYCOIN_EXODUS_EXODUS_H
 
+class CBlock;
 class CBlockIndex;
 class CCoinsView;
 class CCoinsViewCache;
@@ -261,14 +262,26 @@ void NotifyTotalTokensChanged(uint32_t propertyId, int block);
 
 int exodus_handler_disc_begin(int nBlockNow, CBlockIndex const * pBlockIndex);
 int exodus_handler_disc_end(int nBlockNow, CBlockIndex const * pBlockIndex);
-int exodus_handler_block_begin(int nBlockNow, CBlockIndex const * pBlockIndex);
+int exodus_handler_block_begin(int nBlockNow, CBlockIndex const * pBlockIndex, const CBlock* pBlock = nullptr);
 int exodus_handler_block_end(int nBlockNow, CBlockIndex const * pBlockIndex, unsigned int);
 bool exodus_handler_tx(const CTransaction& tx, int nBlock, unsigned int idx, const CBlockIndex* pBlockIndex);
 int exodus_save_state( CBlockIndex const *pBlockIndex );
 
 namespace exodus
 {
+/** Holders of a property, indexed alongside the tallies by update_tally_map(). */
+struct PropertyHolders
+{
+    //! Addresses with a tally record of the property and their tokens, excluding pending amounts
+    std::unordered_map<std::string, int64_t> tokens;
+    //! Sum of the tokens of all holders
+    int64_t totalTokens = 0;
+    //! Number of holders with tokens
+    int64_t owners = 0;
+};
+
 extern std::unordered_map<std::string, CMPTally> mp_tally_map;
+extern std::unordered_map<uint32_t, PropertyHolders> mp_property_holders;
 extern CMPTxList *p_txlistdb;
 extern CMPTradeList *t_tradelistdb;
 extern CMPSTOList *s_stolistdb;
@@ -300,6 +313,7 @@ bool isMainEcosystemProperty(uint32_t propertyId);
 uint32_t GetNextPropertyId(bool maineco); // maybe move into sp
 
 CMPTally* getTally(const std::string& address);
+const PropertyHolders* getPropertyHolders(uint32_t propertyId);
 
 int64_t getTotalTokens(uint32_t propertyId, int64_t* n_owners_total = NULL);
 
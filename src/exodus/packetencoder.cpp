@@ -54,7 +54,8 @@ const CBitcoinAddress& GetSystemAddress()
     return isNonMainNet() ? testAddress : mainAddress;
 }
 
-boost::optional<PacketClass> DeterminePacketClass(const CTransaction& tx, int height)
+// Outputs of all types are inspected, if no height is given
+static boost::optional<PacketClass> ClassifyOutputs(const CTransaction& tx, const int* height)
 {
     // Inspect all outputs.
     auto& sysAddr = GetSystemAddress();
@@ -69,7 +70,7 @@ boost::optional<PacketClass> DeterminePacketClass(const CTransaction& tx, int he
             continue;
         }
 
-        if (!IsAllowedOutputType(type, height)) {
+        if (height && !IsAllowedOutputType(type, *height)) {
             continue;
         }
 
@@ -105,6 +106,16 @@ boost::optional<PacketClass> DeterminePacketClass(const CTransaction& tx, int he
     return boost::none;
 }
 
+boost::optional<PacketClass> DeterminePacketClass(const CTransaction& tx, int height)
+{
+    return ClassifyOutputs(tx, &height);
+}
+
+bool MayHavePacket(const CTransaction& tx)
+{
+    return ClassifyOutputs(tx, nullptr) != boost::none;
+}
+
 } // namespace exodus
 
 namespace std {
@@ -137,6 +137,12 @@ extern const std::array<unsigned char, 6> magic;
 const CBitcoinAddress& GetSystemAddress();
 boost::optional<PacketClass> DeterminePacketClass(const CTransaction& tx, int height);
 
+/**
+ * Checks whether a transaction has the outputs of a packet at any height, without
+ * applying the output types allowed at a height.
+ **/
+bool MayHavePacket(const CTransaction& tx);
+
 /**
  * Embedds a payload in obfuscated multisig outputs, then adds P2PKH output to system address.
  *
@@ -0,0 +1,112 @@
+#include "prevouts.h"
+
+#include "packetencoder.h"
+
+#include "../chain.h"
+#include "../main.h"
+#include "../undo.h"
+
+#include "../primitives/block.h"
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace exodus {
+
+PrevoutCache::PrevoutCache(size_t nMaxSize) : nMaxSize(nMaxSize), nHits(0), nMisses(0)
+{
+}
+
+bool PrevoutCache::Get(const COutPoint& outpoint, CTxOut& txOut)
+{
+    std::map<COutPoint, EntryList::iterator>::const_iterator it = index.find(outpoint);
+    if (it == index.end()) {
+        ++nMisses;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    txOut = it->second->second;
+    ++nHits;
+
+    return true;
+}
+
+void PrevoutCache::Add(const COutPoint& outpoint, const CTxOut& txOut)
+{
+    std::map<COutPoint, EntryList::iterator>::iterator it = index.find(outpoint);
+    if (it != index.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    while (!entries.empty() && entries.size() >= nMaxSize) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+
+    if (nMaxSize == 0) {
+        return;
+    }
+
+    entries.push_front(std::make_pair(outpoint, txOut));
+    index.insert(std::make_pair(outpoint, entries.begin()));
+}
+
+void PrevoutCache::Clear()
+{
+    index.clear();
+    entries.clear();
+}
+
+/**
+ * Collects the previous outputs of transactions, which may carry a packet, from the undo data of a block.
+ *
+ * The undo data is only read, if there is such a transaction. Zerocoin and Sigma spends don't spend
+ * regular outputs, and have no undo data.
+ *
+ * @return False, if the undo data is not available or doesn't match the block
+ */
+bool ReadBlockPrevouts(const CBlock& block, const CBlockIndex* pindex, PrevoutList& prevouts)
+{
+    std::vector<size_t> vCandidates;
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = block.vtx[i];
+        if (!tx.IsZerocoinSpend() && !tx.IsSigmaSpend() && MayHavePacket(tx)) {
+            vCandidates.push_back(i);
+        }
+    }
+
+    if (vCandidates.empty()) {
+        return true;
+    }
+
+    if (!pindex->pprev || !(pindex->nStatus & BLOCK_HAVE_UNDO)) {
+        return false;
+    }
+
+    CBlockUndo blockUndo;
+    if (!UndoReadFromDisk(blockUndo, pindex->GetUndoPos(), pindex->pprev->GetBlockHash())) {
+        return false;
+    }
+    if (blockUndo.vtxundo.size() + 1 != block.vtx.size()) {
+        return false;
+    }
+
+    for (std::vector<size_t>::const_iterator it = vCandidates.begin(); it != vCandidates.end(); ++it) {
+        const CTransaction& tx = block.vtx[*it];
+        const CTxUndo& txUndo = blockUndo.vtxundo[*it - 1];
+        if (txUndo.vprevout.size() != tx.vin.size()) {
+            return false;
+        }
+        for (size_t j = 0; j < tx.vin.size(); ++j) {
+            prevouts.push_back(std::make_pair(tx.vin[j].prevout, txUndo.vprevout[j].txout));
+        }
+    }
+
+    return true;
+}
+
+} // namespace exodus
@@ -0,0 +1,57 @@
+#ifndef EXODUS_PREVOUTS_H
+#define EXODUS_PREVOUTS_H
+
+#include "../primitives/transaction.h"
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+class CBlock;
+class CBlockIndex;
+
+namespace exodus
+{
+//! Previous outputs spent by transactions, in the order they are spent
+typedef std::vector<std::pair<COutPoint, CTxOut> > PrevoutList;
+
+/**
+ * Cache of previous outputs, which evicts the least recently used entries.
+ *
+ * Outputs never change once their transaction is known, so entries remain valid
+ * across reorganizations and never need to be invalidated.
+ */
+class PrevoutCache
+{
+public:
+    explicit PrevoutCache(size_t nMaxSize);
+
+    /** Looks up an output and marks it as most recently used. */
+    bool Get(const COutPoint& outpoint, CTxOut& txOut);
+    /** Adds an output, evicting the least recently used ones, if the cache is full. */
+    void Add(const COutPoint& outpoint, const CTxOut& txOut);
+    void Clear();
+
+    size_t Size() const { return entries.size(); }
+    size_t Hits() const { return nHits; }
+    size_t Misses() const { return nMisses; }
+
+private:
+    typedef std::list<std::pair<COutPoint, CTxOut> > EntryList;
+
+    size_t nMaxSize;
+    size_t nHits;
+    size_t nMisses;
+    //! Entries, the most recently used first
+    EntryList entries;
+    std::map<COutPoint, EntryList::iterator> index;
+};
+
+/** Collects the previous outputs of transactions, which may carry a packet, from the undo data of a block. */
+bool ReadBlockPrevouts(const CBlock& block, const CBlockIndex* pindex, PrevoutList& prevouts);
+}
+
+#endif // EXODUS_PREVOUTS_H
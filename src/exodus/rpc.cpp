@@ -865,27 +865,19 @@ UniValue exodus_getallbalancesforid(const UniValue& params, bool fHelp)
 
     LOCK(cs_main);
 
-    for (std::unordered_map<std::string, CMPTally>::iterator it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-        uint32_t id = 0;
-        bool includeAddress = false;
-        std::string address = it->first;
-        (it->second).init();
-        while (0 != (id = (it->second).next())) {
-            if (id == propertyId) {
-                includeAddress = true;
-                break;
+    // only addresses, which have transacted in this propertyId
+    const PropertyHolders* holders = getPropertyHolders(propertyId);
+    if (holders) {
+        for (std::unordered_map<std::string, int64_t>::const_iterator it = holders->tokens.begin(); it != holders->tokens.end(); ++it) {
+            const std::string& address = it->first;
+            UniValue balanceObj(UniValue::VOBJ);
+            balanceObj.push_back(Pair("address", address));
+            bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, isDivisible);
+
+            if (nonEmptyBalance) {
+                response.push_back(balanceObj);
             }
         }
-        if (!includeAddress) {
-            continue; // ignore this address, has never transacted in this propertyId
-        }
-        UniValue balanceObj(UniValue::VOBJ);
-        balanceObj.push_back(Pair("address", address));
-        bool nonEmptyBalance = BalanceToJSON(address, propertyId, balanceObj, isDivisible);
-
-        if (nonEmptyBalance) {
-            response.push_back(balanceObj);
-        }
     }
 
     return response;
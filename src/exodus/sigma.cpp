@@ -6,9 +6,6 @@
 #include "../main.h"
 #include "../sync.h"
 
-#include <iterator>
-#include <vector>
-
 namespace exodus {
 
 bool VerifySigmaSpend(
@@ -18,11 +15,12 @@ bool VerifySigmaSpend(
     size_t groupSize,
     const SigmaProof& proof)
 {
-    std::vector<SigmaPublicKey> anonimitySet; // Don't preallocate the vector due to it will allow attacker to crash all client.
+    // Mints are shared with the cache of the database, nothing is allocated for the requested size.
+    SigmaAnonimityGroup anonimitySet;
 
     {
         LOCK(cs_main);
-        sigmaDb->GetAnonimityGroup(property, denomination, group, groupSize, std::back_inserter(anonimitySet));
+        anonimitySet = sigmaDb->GetAnonimityGroup(property, denomination, group, groupSize);
     }
 
     // If the size of anonimity set is not the expected once then no need to verify the proof.
@@ -16,6 +16,7 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -250,7 +251,7 @@ constexpr uint16_t SigmaDatabase::MAX_GROUP_SIZE;
 // 0<prob_id><denom><group_id><idx>=<GroupElement><int>
 // Sequence of mint sorted following blockchain
 // 1<seq uint64>=key
-SigmaDatabase::SigmaDatabase(const boost::filesystem::path& path, bool wipe, uint16_t groupSize)
+SigmaDatabase::SigmaDatabase(const boost::filesystem::path& path, bool wipe, uint16_t groupSize) : cachedMints(0)
 {
     auto status = Open(path, wipe);
     if (!status.ok()) {
@@ -291,6 +292,7 @@ std::pair<SigmaMintGroup, SigmaMintIndex> SigmaDatabase::RecordMint(
     pubKey.commitment.serialize(buffer.data());
 
     AddEntry(key, GetSlice(buffer), height);
+    AddCachedMint(GroupKey(propertyId, denomination, lastGroup), nextIdx, pubKey);
 
     // Raise event.
     MintAdded(propertyId, denomination, lastGroup, nextIdx, pubKey, height);
@@ -368,6 +370,7 @@ void SigmaDatabase::DeleteAll(int startBlock)
 
     leveldb::WriteBatch batch;
     std::vector<std::function<void()>> defers; // functions to be called after delete whole keys
+    std::set<GroupKey> groups; // groups losing mints
     for (; it->Valid() && IsSequenceEntry(it.get()); it->Prev()) {
 
         CDataStream deserialized(
@@ -413,6 +416,7 @@ void SigmaDatabase::DeleteAll(int startBlock)
             defers.push_back([this, propertyId, denomination, pub]() {
                 MintRemoved(propertyId, denomination, pub);
             });
+            groups.insert(GroupKey(propertyId, denomination, groupId));
 
             batch.Delete(GetSlice(entry.data));
         } else if (entry.op == OpCode::StoreSpendSerial) {
@@ -445,6 +449,13 @@ void SigmaDatabase::DeleteAll(int startBlock)
         throw std::runtime_error("Fail to update database");
     }
 
+    {
+        LOCK(cs_anonimityGroups);
+        for (auto& group : groups) {
+            EraseCachedGroup(group);
+        }
+    }
+
     for (auto &defer : defers) {
         defer();
     }
@@ -516,9 +527,124 @@ uint16_t SigmaDatabase::InitGroupSize(uint16_t groupSize)
     return groupSize;
 }
 
+void SigmaDatabase::Clear()
+{
+    CDBBase::Clear();
+
+    LOCK(cs_anonimityGroups);
+    anonimityGroups.clear();
+    cachedGroups.clear();
+    cachedMints = 0;
+}
+
 size_t SigmaDatabase::GetAnonimityGroup(
     uint32_t propertyId, uint8_t denomination, uint32_t groupId, size_t count,
     std::function<void(exodus::SigmaPublicKey&)> insertF)
+{
+    auto group = GetAnonimityGroup(propertyId, denomination, groupId, count);
+
+    for (auto& mint : group) {
+        auto pub = mint;
+        insertF(pub);
+    }
+
+    return group.size();
+}
+
+SigmaAnonimityGroup SigmaDatabase::GetAnonimityGroup(
+    uint32_t propertyId, uint8_t denomination, uint32_t groupId, size_t count)
+{
+    LOCK(cs_anonimityGroups);
+
+    auto mints = GetCachedGroup(GroupKey(propertyId, denomination, groupId));
+    return SigmaAnonimityGroup(mints, std::min(count, mints->size()));
+}
+
+std::shared_ptr<std::vector<SigmaPublicKey>> SigmaDatabase::GetCachedGroup(const GroupKey& key)
+{
+    AssertLockHeld(cs_anonimityGroups);
+
+    auto it = anonimityGroups.find(key);
+    if (it != anonimityGroups.end()) {
+        cachedGroups.splice(cachedGroups.begin(), cachedGroups, it->second);
+        return it->second->second;
+    }
+
+    auto mints = std::make_shared<std::vector<SigmaPublicKey>>();
+    mints->reserve(groupSize);
+
+    ReadAnonimityGroup(std::get<0>(key), std::get<1>(key), std::get<2>(key), MAX_GROUP_SIZE,
+        [&mints](exodus::SigmaPublicKey& pub) {
+            mints->push_back(std::move(pub));
+        });
+
+    cachedGroups.emplace_front(key, mints);
+    anonimityGroups[key] = cachedGroups.begin();
+    cachedMints += mints->size();
+    TrimCachedGroups();
+
+    return mints;
+}
+
+void SigmaDatabase::AddCachedMint(const GroupKey& key, uint16_t index, const SigmaPublicKey& pubKey)
+{
+    LOCK(cs_anonimityGroups);
+
+    auto it = anonimityGroups.find(key);
+    if (it == anonimityGroups.end()) {
+        return;
+    }
+
+    auto& mints = it->second->second;
+    if (index != mints->size()) {
+        // should not happen, read the group again when it is needed
+        EraseCachedGroup(key);
+        return;
+    }
+
+    if (mints->size() == mints->capacity()) {
+        // groups handed out point to the current storage, continue in a new one
+        auto grown = std::make_shared<std::vector<SigmaPublicKey>>();
+        grown->reserve(std::max<size_t>(groupSize, 2 * mints->size()));
+        grown->assign(mints->begin(), mints->end());
+        mints = grown;
+    }
+
+    mints->push_back(pubKey);
+    cachedMints++;
+    TrimCachedGroups();
+}
+
+void SigmaDatabase::EraseCachedGroup(const GroupKey& key)
+{
+    AssertLockHeld(cs_anonimityGroups);
+
+    auto it = anonimityGroups.find(key);
+    if (it == anonimityGroups.end()) {
+        return;
+    }
+
+    cachedMints -= it->second->second->size();
+    cachedGroups.erase(it->second);
+    anonimityGroups.erase(it);
+}
+
+void SigmaDatabase::TrimCachedGroups()
+{
+    AssertLockHeld(cs_anonimityGroups);
+
+    // the most recently used group is kept even if it alone exceeds the limit
+    while (cachedMints > MAX_CACHED_MINTS && cachedGroups.size() > 1) {
+        auto& last = cachedGroups.back();
+        cachedMints -= last.second->size();
+        anonimityGroups.erase(last.first);
+        cachedGroups.pop_back();
+    }
+}
+
+size_t SigmaDatabase::ReadAnonimityGroup(
+    uint32_t propertyId, uint8_t denomination, uint32_t groupId, size_t count,
+    std::function<void(exodus::SigmaPublicKey&)> insertF)
 {
     auto firstKey = CreateMintKey(propertyId, denomination, groupId, 0);
 
@@ -539,13 +665,13 @@ size_t SigmaDatabase::GetAnonimityGroup(
         }
 
         if (mintIdx != i) {
-            throw std::runtime_error("GetAnonimityGroup() : coin index is out of order");
+            throw std::runtime_error("ReadAnonimityGroup() : coin index is out of order");
         }
 
         auto pub = ParseMint(it->value().ToString());
 
         if (!pub.commitment.isMember()) {
-            throw std::runtime_error("GetAnonimityGroup() : coin is invalid");
+            throw std::runtime_error("ReadAnonimityGroup() : coin is invalid");
         }
         insertF(pub);
     }
@@ -6,6 +6,7 @@
 #include "property.h"
 #include "sigmaprimitives.h"
 
+#include "../sync.h"
 #include "../uint256.h"
 
 #include <univalue.h>
@@ -15,7 +16,11 @@
 
 #include <leveldb/slice.h>
 
+#include <list>
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <inttypes.h>
@@ -34,6 +39,33 @@ struct is_iterator<T, typename std::enable_if<!std::is_same<typename std::iterat
 
 namespace exodus {
 
+/**
+ * Decoded mints of an anonimity group, shared with the cache of SigmaDatabase. The mints stay valid as
+ * long as the object is alive, even if the group is changed or dropped from the cache in the meantime.
+ */
+class SigmaAnonimityGroup
+{
+public:
+    SigmaAnonimityGroup() : first(nullptr), count(0)
+    {
+    }
+
+    SigmaAnonimityGroup(std::shared_ptr<const std::vector<SigmaPublicKey>> mints, size_t count)
+        : mints(std::move(mints)), first(this->mints->data()), count(count)
+    {
+    }
+
+public:
+    const SigmaPublicKey* begin() const { return first; }
+    const SigmaPublicKey* end() const { return first + count; }
+    size_t size() const { return count; }
+
+private:
+    std::shared_ptr<const std::vector<SigmaPublicKey>> mints;
+    const SigmaPublicKey* first;
+    size_t count;
+};
+
 class SigmaDatabase : public CDBBase
 {
 public:
@@ -42,6 +74,11 @@ public:
      */
     static constexpr uint16_t MAX_GROUP_SIZE = 16384;
 
+    /**
+     * Limit of decoded mints kept in the anonimity group cache, enough for a few full groups.
+     */
+    static constexpr size_t MAX_CACHED_MINTS = 4 * MAX_GROUP_SIZE;
+
 public:
     SigmaDatabase(const boost::filesystem::path& path, bool wipe, uint16_t groupSize = 0);
     ~SigmaDatabase() override;
@@ -74,6 +111,11 @@ public:
     size_t GetAnonimityGroup(uint32_t propertyId, uint8_t denomination, uint32_t groupId, size_t count,
         std::function<void(exodus::SigmaPublicKey&)>);
 
+    /**
+     * Returns at most count first mints of the group without copying them.
+     */
+    SigmaAnonimityGroup GetAnonimityGroup(uint32_t propertyId, uint8_t denomination, uint32_t groupId, size_t count);
+
     template<class OutputIt>
     OutputIt GetAnonimityGroup(uint32_t propertyId, uint8_t denomination, uint32_t groupId, OutputIt firstIt)
     {
@@ -86,6 +128,9 @@ public:
 
     void DeleteAll(int startBlock);
 
+    /** Extends clearing of CDBBase. */
+    void Clear();
+
     uint32_t GetLastGroupId(uint32_t propertyId, uint8_t denomination);
     size_t GetMintCount(uint32_t propertyId, uint8_t denomination, uint32_t groupId);
     uint64_t GetNextSequence();
@@ -105,10 +150,34 @@ protected:
     void AddEntry(const leveldb::Slice& key, const leveldb::Slice& value, int block);
 
 private:
+    typedef std::tuple<uint32_t, uint8_t, uint32_t> GroupKey;
+
     void RecordGroupSize(uint16_t groupSize);
 
     std::unique_ptr<leveldb::Iterator> NewIterator() const;
 
+    size_t ReadAnonimityGroup(uint32_t propertyId, uint8_t denomination, uint32_t groupId, size_t count,
+        std::function<void(exodus::SigmaPublicKey&)>);
+
+    typedef std::list<std::pair<GroupKey, std::shared_ptr<std::vector<SigmaPublicKey>>>> CachedGroupList;
+
+    // Loads the group into the cache if it is not there yet and marks it as most recently used
+    std::shared_ptr<std::vector<SigmaPublicKey>> GetCachedGroup(const GroupKey& key);
+    void AddCachedMint(const GroupKey& key, uint16_t index, const SigmaPublicKey& pubKey);
+    void EraseCachedGroup(const GroupKey& key);
+    // Drops the least recently used groups until at most MAX_CACHED_MINTS mints are cached
+    void TrimCachedGroups();
+
+    /**
+     * Decoded mints of recently used groups, the most recently used first. Mints are appended as they
+     * are recorded and storage for a whole group is reserved up front, so handing out the first mints of
+     * a group needs no copy. Groups touched by DeleteAll are dropped and read again on the next request.
+     */
+    CachedGroupList cachedGroups;
+    std::map<GroupKey, CachedGroupList::iterator> anonimityGroups;
+    size_t cachedMints;
+    CCriticalSection cs_anonimityGroups;
+
 protected:
     uint16_t InitGroupSize(uint16_t groupSize);
     uint16_t GetGroupSize();
@@ -41,29 +41,25 @@ OwnerAddrType STO_GetReceivers(const std::string& sender, uint32_t property, int
 
     {
         LOCK(cs_main);
-        std::unordered_map<std::string, CMPTally>::iterator it;
-
-        for (it = mp_tally_map.begin(); it != mp_tally_map.end(); ++it) {
-            const std::string& address = it->first;
-            const CMPTally& tally = it->second;
-
-            int64_t tokens = 0;
-            tokens += tally.getMoney(property, BALANCE);
-            tokens += tally.getMoney(property, SELLOFFER_RESERVE);
-            tokens += tally.getMoney(property, ACCEPT_RESERVE);
-            tokens += tally.getMoney(property, METADEX_RESERVE);
-
-            // Do not include the sender
-            if (address == sender) {
-                senderTokens = tokens;
-                continue;
-            }
+        const PropertyHolders* holders = getPropertyHolders(property);
+
+        if (holders) {
+            for (std::unordered_map<std::string, int64_t>::const_iterator it = holders->tokens.begin(); it != holders->tokens.end(); ++it) {
+                const std::string& address = it->first;
+                int64_t tokens = it->second;
+
+                // Do not include the sender
+                if (address == sender) {
+                    senderTokens = tokens;
+                    continue;
+                }
 
-            totalTokens += tokens;
+                totalTokens += tokens;
 
-            // Only holders with balance are relevant
-            if (0 < tokens) {
-                ownerAddrSet.insert(std::make_pair(tokens, address));
+                // Only holders with balance are relevant
+                if (0 < tokens) {
+                    ownerAddrSet.insert(std::make_pair(tokens, address));
+                }
             }
         }
     }
@@ -87,13 +87,11 @@ SigmaSpend Wallet::CreateSigmaSpend(PropertyId property, SigmaDenomination denom
     }
 
     // Get anonimity set for spend.
-    std::vector<SigmaPublicKey> anonimitySet;
-
-    sigmaDb->GetAnonimityGroup(
+    auto anonimitySet = sigmaDb->GetAnonimityGroup(
         mint->property,
         mint->denomination,
         mint->chainState.group,
-        std::back_inserter(anonimitySet)
+        SigmaDatabase::MAX_GROUP_SIZE
     );
 
     if (anonimitySet.size() < 2) {
@@ -0,0 +1,320 @@
+#ifndef GRAVITYCOIN_FLATHASHMAP_H
+#define GRAVITYCOIN_FLATHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Hash map with open addressing and Robin Hood probing.
+ *
+ * Entries live in one array next to their hash, so a lookup usually touches a single
+ * cache line and the key hash is computed once per entry, not again on every rehash.
+ * Erasing shifts the rest of the probe sequence back instead of leaving tombstones.
+ *
+ * Differs from std::unordered_map in that inserting or erasing invalidates every
+ * iterator and reference, and erase(iterator) may move an entry already visited by
+ * a running iteration in front of the iterator again. Keys must not be modified
+ * through iterators.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class flathashmap {
+public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<K, V> value_type;
+    typedef std::size_t size_type;
+    typedef Hash hasher;
+    typedef KeyEqual key_equal;
+
+private:
+    struct Slot {
+        // 0 if the slot is empty, otherwise the distance from the entry's home slot plus one
+        uint32_t dist;
+        std::size_t hash;
+        typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage;
+
+        value_type& value() { return *reinterpret_cast<value_type*>(&storage); }
+        const value_type& value() const { return *reinterpret_cast<const value_type*>(&storage); }
+    };
+
+    template <bool IsConst>
+    class iterator_base {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename flathashmap::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<IsConst, const value_type*, value_type*>::type pointer;
+        typedef typename std::conditional<IsConst, const value_type&, value_type&>::type reference;
+
+        iterator_base() : slot(nullptr), last(nullptr) {}
+
+        // iterator converts to const_iterator
+        template <bool C = IsConst, typename = typename std::enable_if<C>::type>
+        iterator_base(const iterator_base<false>& other) : slot(other.slot), last(other.last) {}
+
+        reference operator*() const { return slot->value(); }
+        pointer operator->() const { return &slot->value(); }
+
+        iterator_base& operator++() { ++slot; SkipEmpty(); return *this; }
+        iterator_base operator++(int) { iterator_base copy(*this); ++*this; return copy; }
+
+        friend bool operator==(const iterator_base& a, const iterator_base& b) { return a.slot == b.slot; }
+        friend bool operator!=(const iterator_base& a, const iterator_base& b) { return a.slot != b.slot; }
+
+    private:
+        friend class flathashmap;
+        template <bool> friend class iterator_base;
+
+        typedef typename std::conditional<IsConst, const Slot*, Slot*>::type slot_pointer;
+        slot_pointer slot;
+        slot_pointer last;
+
+        iterator_base(slot_pointer slot, slot_pointer last) : slot(slot), last(last) { SkipEmpty(); }
+
+        void SkipEmpty() {
+            while (slot != last && slot->dist == 0)
+                ++slot;
+        }
+    };
+
+public:
+    typedef iterator_base<false> iterator;
+    typedef iterator_base<true> const_iterator;
+
+    flathashmap() : capacity(0), used(0) {}
+
+    flathashmap(const flathashmap& other) : capacity(0), used(0) {
+        if (other.capacity == 0)
+            return;
+        slots.reset(new Slot[other.capacity]());
+        capacity = other.capacity;
+        // the same capacity gives every entry the same slot
+        for (size_type i = 0; i < capacity; i++) {
+            if (other.slots[i].dist != 0) {
+                new (&slots[i].storage) value_type(other.slots[i].value());
+                slots[i].dist = other.slots[i].dist;
+                slots[i].hash = other.slots[i].hash;
+                used++;
+            }
+        }
+    }
+
+    flathashmap(flathashmap&& other) noexcept : flathashmap() { swap(other); }
+
+    flathashmap& operator=(flathashmap other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~flathashmap() { DestroyAll(); }
+
+    void swap(flathashmap& other) noexcept {
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(used, other.used);
+        std::swap(hash, other.hash);
+        std::swap(equal, other.equal);
+    }
+
+    size_type size() const { return used; }
+    bool empty() const { return used == 0; }
+
+    iterator begin() { return iterator(slots.get(), slots.get() + capacity); }
+    iterator end() { return iterator(slots.get() + capacity, slots.get() + capacity); }
+    const_iterator begin() const { return const_iterator(slots.get(), slots.get() + capacity); }
+    const_iterator end() const { return const_iterator(slots.get() + capacity, slots.get() + capacity); }
+
+    iterator find(const K& key) { return MakeIterator(Find(key, hash(key))); }
+    const_iterator find(const K& key) const { return MakeIterator(Find(key, hash(key))); }
+    size_type count(const K& key) const { return Find(key, hash(key)) != capacity; }
+
+    std::pair<iterator, iterator> equal_range(const K& key) {
+        iterator it = find(key);
+        if (it == end())
+            return std::make_pair(it, it);
+        iterator next = it;
+        return std::make_pair(it, ++next);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+        const_iterator it = find(key);
+        if (it == end())
+            return std::make_pair(it, it);
+        const_iterator next = it;
+        return std::make_pair(it, ++next);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        std::size_t h = hash(value.first);
+        size_type pos = Find(value.first, h);
+        if (pos != capacity)
+            return std::make_pair(MakeIterator(pos), false);
+        return std::make_pair(MakeIterator(InsertNew(value_type(value), h)), true);
+    }
+
+    // hint is ignored, for the generic map serialization in serialize.h
+    iterator insert(const_iterator hint, const value_type& value) { return insert(value).first; }
+
+    V& operator[](const K& key) {
+        std::size_t h = hash(key);
+        size_type pos = Find(key, h);
+        if (pos == capacity)
+            pos = InsertNew(value_type(key, V()), h);
+        return slots[pos].value().second;
+    }
+
+    size_type erase(const K& key) {
+        size_type pos = Find(key, hash(key));
+        if (pos == capacity)
+            return 0;
+        Erase(pos);
+        return 1;
+    }
+
+    iterator erase(const_iterator it) {
+        size_type pos = it.slot - slots.get();
+        Erase(pos);
+        return MakeIterator(pos);
+    }
+
+    void clear() {
+        DestroyAll();
+        for (size_type i = 0; i < capacity; i++)
+            slots[i].dist = 0;
+        used = 0;
+    }
+
+    void reserve(size_type n) {
+        size_type newCapacity = capacity ? capacity : MIN_CAPACITY;
+        while (n * LOAD_DENOMINATOR > newCapacity * LOAD_NUMERATOR)
+            newCapacity *= 2;
+        if (newCapacity > capacity)
+            Rehash(newCapacity);
+    }
+
+private:
+    static const size_type MIN_CAPACITY = 16;
+    // maximum load factor, Robin Hood probing keeps probe sequences short up to high loads
+    static const size_type LOAD_NUMERATOR = 7;
+    static const size_type LOAD_DENOMINATOR = 8;
+
+    std::unique_ptr<Slot[]> slots;
+    // zero or a power of two
+    size_type capacity;
+    size_type used;
+    Hash hash;
+    KeyEqual equal;
+
+    iterator MakeIterator(size_type pos) { return iterator(slots.get() + pos, slots.get() + capacity); }
+    const_iterator MakeIterator(size_type pos) const { return const_iterator(slots.get() + pos, slots.get() + capacity); }
+
+    // Returns the slot holding the key or capacity if there is none
+    size_type Find(const K& key, std::size_t h) const {
+        if (capacity == 0)
+            return capacity;
+        size_type mask = capacity - 1;
+        size_type pos = h & mask;
+        for (uint32_t dist = 1; ; dist++, pos = (pos + 1) & mask) {
+            const Slot& slot = slots[pos];
+            // an entry closer to its home slot than we are means the key is not in the table
+            if (slot.dist < dist)
+                return capacity;
+            if (slot.hash == h && equal(slot.value().first, key))
+                return pos;
+        }
+    }
+
+    // Inserts a key known to be absent, returns its slot
+    size_type InsertNew(value_type&& value, std::size_t h) {
+        if ((used + 1) * LOAD_DENOMINATOR > capacity * LOAD_NUMERATOR)
+            Rehash(capacity ? capacity * 2 : MIN_CAPACITY);
+        size_type pos = Place(std::move(value), h);
+        used++;
+        return pos;
+    }
+
+    size_type Place(value_type&& value, std::size_t h) {
+        size_type mask = capacity - 1;
+        size_type pos = h & mask;
+        size_type result = capacity;
+        uint32_t dist = 1;
+        for (; ; dist++, pos = (pos + 1) & mask) {
+            Slot& slot = slots[pos];
+            if (slot.dist == 0) {
+                new (&slot.storage) value_type(std::move(value));
+                slot.dist = dist;
+                slot.hash = h;
+                return result == capacity ? pos : result;
+            }
+            if (slot.dist < dist) {
+                // take the slot from the entry that is closer to home and carry that one on
+                std::swap(slot.value(), value);
+                std::swap(slot.dist, dist);
+                std::swap(slot.hash, h);
+                if (result == capacity)
+                    result = pos;
+            }
+        }
+    }
+
+    void Erase(size_type pos) {
+        size_type mask = capacity - 1;
+        slots[pos].value().~value_type();
+        slots[pos].dist = 0;
+        // shift the following entries that are away from home back by one
+        for (size_type next = (pos + 1) & mask; slots[next].dist > 1; pos = next, next = (next + 1) & mask) {
+            new (&slots[pos].storage) value_type(std::move(slots[next].value()));
+            slots[pos].dist = slots[next].dist - 1;
+            slots[pos].hash = slots[next].hash;
+            slots[next].value().~value_type();
+            slots[next].dist = 0;
+        }
+        used--;
+    }
+
+    void Rehash(size_type newCapacity) {
+        std::unique_ptr<Slot[]> oldSlots(std::move(slots));
+        size_type oldCapacity = capacity;
+        slots.reset(new Slot[newCapacity]());
+        capacity = newCapacity;
+        for (size_type i = 0; i < oldCapacity; i++) {
+            if (oldSlots[i].dist != 0) {
+                Place(std::move(oldSlots[i].value()), oldSlots[i].hash);
+                oldSlots[i].value().~value_type();
+            }
+        }
+    }
+
+    void DestroyAll() {
+        for (size_type i = 0; i < capacity; i++) {
+            if (slots[i].dist != 0)
+                slots[i].value().~value_type();
+        }
+    }
+};
+
+/** Set counterpart of flathashmap, with the same iterator invalidation rules. */
+template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class flathashset {
+public:
+    typedef K key_type;
+    typedef std::size_t size_type;
+
+    bool insert(const K& key) { return map.insert(std::make_pair(key, true)).second; }
+    size_type erase(const K& key) { return map.erase(key); }
+    size_type count(const K& key) const { return map.count(key); }
+    size_type size() const { return map.size(); }
+    bool empty() const { return map.empty(); }
+    void clear() { map.clear(); }
+
+private:
+    flathashmap<K, bool, Hash, KeyEqual> map;
+};
+
+#endif // GRAVITYCOIN_FLATHASHMAP_H
@@ -382,7 +382,8 @@ bool CHDMintWallet::SeedToMint(const uint512& mintSeed, GroupElement& commit, si
 
     // Generate a Pedersen commitment to the serial number
     commit = sigma::SigmaPrimitives<Scalar, GroupElement>::commit(
-             coin.getParams()->get_g(), coin.getSerialNumber(), coin.getParams()->get_h0(), coin.getRandomness());
+             coin.getParams()->get_g(), coin.getSerialNumber(), coin.getParams()->get_h0(), coin.getRandomness(),
+             coin.getParams()->get_tables());
 
     return true;
 }
@@ -17,6 +17,7 @@
 #include "checkpoints.h"
 #include "compat/sanity.h"
 #include "consensus/validation.h"
+#include "crypto/Lyra2Z/Lyra2.h"
 #include "exodus/exodus.h"
 #include "httpserver.h"
 #include "httprpc.h"
@@ -30,6 +31,7 @@
 #include "script/standard.h"
 #include "script/sigcache.h"
 #include "scheduler.h"
+#include "sigma.h"
 #include "timedata.h"
 #include "txdb.h"
 #include "txmempool.h"
@@ -421,6 +423,9 @@ std::string HelpMessage(HelpMessageMode mode) {
         strUsage += HelpMessageOpt("-feefilter", strprintf(
                 "Tell other nodes to filter invs to us by our mempool min fee (default: %u)", DEFAULT_FEEFILTER));
     strUsage += HelpMessageOpt("-loadblock=<file>", _("Imports blocks from external blk000??.dat file on startup"));
+    strUsage += HelpMessageOpt("-lyra2zhugepages", strprintf(
+            _("Back Lyra2Z memory of hashing threads with huge pages if the system provides them (default: %u)"),
+            DEFAULT_LYRA2Z_HUGE_PAGES));
     strUsage += HelpMessageOpt("-maxorphantx=<n>",
                                strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"),
                                          DEFAULT_MAX_ORPHAN_TRANSACTIONS));
@@ -430,7 +435,7 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(
             _("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(
-            _("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
+            _("Set the number of script and sigma proof verification threads, both share the same threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
             -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), BITCOIN_PID_FILENAME));
@@ -562,6 +567,9 @@ std::string HelpMessage(HelpMessageMode mode) {
         strUsage += HelpMessageOpt("-checkblockindex", strprintf(
                 "Do a full consistency check for mapBlockIndex, setBlockIndexCandidates, chainActive and mapBlocksUnlinked occasionally. Also sets -checkmempool (default: %u)",
                 Params(CBaseChainParams::MAIN).DefaultConsistencyChecks()));
+        strUsage += HelpMessageOpt("-checkblockreadpow", strprintf(
+                "Check proof of work of every block read from disk, including blocks already in the block index (default: %u)",
+                DEFAULT_CHECK_BLOCK_READ_POW));
         strUsage += HelpMessageOpt("-checkmempool=<n>", strprintf("Run checks every <n> transactions (default: %u)",
                                                                   Params(CBaseChainParams::MAIN).DefaultConsistencyChecks()));
         strUsage += HelpMessageOpt("-checkpoints",
@@ -604,6 +612,9 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageOpt("-genproclimit=<n>", strprintf(
             _("Set the number of threads for coin generation if enabled (-1 = all cores, default: %d)"),
             DEFAULT_GENERATE_THREADS));
+    strUsage += HelpMessageOpt("-minerlanes=<n>", strprintf(
+            _("Set the number of nonces each generation thread hashes at once (default: %d)"),
+            DEFAULT_MINER_LANES));
 
     strUsage += HelpMessageOpt("-help-debug", _("Show all debugging options (usage: --help -help-debug)"));
     strUsage += HelpMessageOpt("-logips",
@@ -624,6 +635,9 @@ std::string HelpMessage(HelpMessageMode mode) {
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>",
                                    strprintf("Limit size of signature cache to <n> MiB (default: %u)",
                                              DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-maxsigmaproofcachesize=<n>",
+                                   strprintf("Limit size of verified sigma proof cache to <n> MiB (default: %u)",
+                                             sigma::DEFAULT_MAX_SIGMA_PROOF_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf(
                 "Maximum tip age in seconds to consider node in initial block download (default: %u)",
                 DEFAULT_MAX_TIP_AGE));
@@ -706,8 +720,9 @@ std::string HelpMessage(HelpMessageMode mode) {
     strUsage += HelpMessageGroup("Exodus options:");
     strUsage += HelpMessageOpt("-exodus", "Enable Exodus");
     strUsage += HelpMessageOpt("-startclean", "Clear all persistence files on startup; triggers reparsing of Exodus transactions");
-    strUsage += HelpMessageOpt("-exodustxcache=<num>", "The maximum number of transactions in the input transaction cache (default: 500000)");
+    strUsage += HelpMessageOpt("-exodustxcache=<num>", "The maximum number of previous outputs in the input cache (default: 500000)");
     strUsage += HelpMessageOpt("-exodusprogressfrequency=<seconds>", "Time in seconds after which the initial scanning progress is reported (default: 30)");
+    strUsage += HelpMessageOpt("-exodusscanthreads=<n>", "Number of threads reading blocks ahead during the initial scan (default: number of cores, at most 4)");
     strUsage += HelpMessageOpt("-exodusdebug=<category>", "Enable or disable log categories, can be \"all\" or \"none\"");
     strUsage += HelpMessageOpt("-autocommit=<flag>", "Enable or disable broadcasting of transactions, when creating transactions (default: 1)");
     strUsage += HelpMessageOpt("-overrideforcedshutdown=<flag>", "Disable force shutdown when error (default: 0)");
@@ -1265,6 +1280,7 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
         stempool.setSanityCheck(1.0 / ratio);
     }
     fCheckBlockIndex = GetBoolArg("-checkblockindex", chainparams.DefaultConsistencyChecks());
+    fCheckBlockReadPoW = GetBoolArg("-checkblockreadpow", DEFAULT_CHECK_BLOCK_READ_POW);
     fCheckpointsEnabled = GetBoolArg("-checkpoints", DEFAULT_CHECKPOINTS_ENABLED);
 
     // mempool AC_CONFIG_SUBDIRSlimits
@@ -1408,6 +1424,9 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     if (!InitSanityCheck())
         return InitError(strprintf(_("Initialization sanity check failed. %s is shutting down."), _(PACKAGE_NAME)));
 
+    // Pick the Lyra2 row operations before any thread hashes, they fall back to the generic code if the self-test fails
+    const char* lyra2RowFunctions = selectRowFunctions();
+
     std::string strDataDir = GetDataDir().string();
 
     // Make sure only a single Bitcoin process is using the data directory.
@@ -1443,10 +1462,12 @@ bool AppInit2(boost::thread_group &threadGroup, CScheduler &scheduler) {
     LogPrintf("Using at most %i connections (%i file descriptors available)\n", nMaxConnections, nFD);
     std::ostringstream strErrors;
 
-    LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
+    LogPrintf("Using %u threads for script and sigma proof verification\n", nScriptCheckThreads);
+    LogPrintf("Using %s Lyra2 row operations\n", lyra2RowFunctions);
     if (nScriptCheckThreads) {
-        for (int i = 0; i < nScriptCheckThreads - 1; i++)
+        for (int i = 0; i < nScriptCheckThreads - 1; i++) {
             threadGroup.create_thread(&ThreadScriptCheck);
+        }
     }
 
     if (mapArgs.count("-sporkkey")) // spork priv key
@@ -34,6 +34,11 @@ namespace libzerocoin {
 // Number of seconds before thread shuts down if idle
 constexpr static int secondsBeforeThreadShutdown = 10;
 
+// Set on the pool's own threads. A pool thread waiting for tasks added from inside a running
+// task runs queued tasks meanwhile: otherwise every thread of the pool could block while the
+// nested tasks sit in the queue.
+static thread_local bool fPoolThread = false;
+
 // Simple thread pool class for using multiple cores effeciently
 
 static class ParallelOpThreadPool {
@@ -47,6 +52,7 @@ private:
     size_t                                    numberOfThreads;
 
     void ThreadProc() {
+        fPoolThread = true;
         for (;;) {
             boost::packaged_task<void> job;
             {
@@ -119,6 +125,24 @@ public:
         return ret;
     }
 
+    bool IsPoolThread() const {
+        return fPoolThread;
+    }
+
+    // Run one queued task on the calling thread, returns false if there is nothing to run
+    bool RunQueuedTask() {
+        boost::packaged_task<void> job;
+        {
+            boost::unique_lock<boost::mutex> lock(taskQueueMutex);
+            if (taskQueue.empty())
+                return false;
+            job = std::move(taskQueue.front());
+            taskQueue.pop();
+        }
+        job();
+        return true;
+    }
+
 } s_parallelOpThreadPool;
 
 #else
@@ -131,6 +155,14 @@ public:
         promise.set_value();
         return promise.get_future();
     }
+
+    bool IsPoolThread() const {
+        return false;
+    }
+
+    bool RunQueuedTask() {
+        return false;
+    }
 } s_parallelOpThreadPool;
 
 #endif
@@ -146,6 +178,16 @@ void ParallelTasks::Add(function<void()> task) {
 }
 
 void ParallelTasks::Wait() {
+    // let every task finish before rethrowing an exception, tasks usually refer to the caller's stack
+    for (boost::future<void> &f: tasks) {
+        // a pool thread keeps running queued tasks meanwhile, so tasks added from a task still
+        // spread over the whole pool. Its own tasks are either queued or running on other threads
+        while (s_parallelOpThreadPool.IsPoolThread() && !f.is_ready()) {
+            if (!s_parallelOpThreadPool.RunQueuedTask())
+                f.wait_for(boost::chrono::milliseconds(1));
+        }
+        f.wait();
+    }
     for (boost::future<void> &f: tasks)
         f.get();
 }
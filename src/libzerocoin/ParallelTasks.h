@@ -30,7 +30,7 @@ namespace libzerocoin {
 
 class ParallelTasks {
 private:
-    vector<boost::future<void>> tasks;
+    std::vector<boost::future<void>> tasks;
 
 public:
     ParallelTasks(int n=0);
@@ -38,7 +38,8 @@ public:
     // add new task
     void Add(std::function<void()> task);
 
-    // wait for everything added so far
+    // wait for everything added so far, rethrows the first exception thrown by a task.
+    // Called from a task of the pool, runs other queued tasks while waiting
     void Wait();
 
     // clear all the tasks from the waiting list
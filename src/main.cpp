@@ -96,6 +96,7 @@ bool fTimestampIndex = false;
 bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
+bool fCheckBlockReadPoW = DEFAULT_CHECK_BLOCK_READ_POW;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
 size_t nCoinCacheUsage = 5000 * 300;
 uint64_t nPruneTarget = 0;
@@ -2042,7 +2043,7 @@ bool WriteBlockToDisk(const CBlock &block, CDiskBlockPos &pos, const CMessageHea
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
+static bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, bool fCheckPoW, const Consensus::Params &consensusParams) {
     block.SetNull();
 
     // Open history file to read
@@ -2059,20 +2060,35 @@ bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, con
     }
 
     // Check the header
-    if (!CheckProofOfWork(block.GetPoWHash(), block.nBits, consensusParams)){
+    if (fCheckPoW && !CheckProofOfWork(block.GetPoWHash(), block.nBits, consensusParams)){
             return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
     }
     return true;
 }
 
+bool ReadBlockFromDisk(CBlock &block, const CDiskBlockPos &pos, int nHeight, const Consensus::Params &consensusParams) {
+    return ReadBlockFromDisk(block, pos, true, consensusParams);
+}
+
 bool ReadBlockFromDisk(CBlock &block, const CBlockIndex *pindex, const Consensus::Params &consensusParams) {
-    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), pindex->nHeight, consensusParams))
+    // Proof of work of the blocks in the index was checked when they were accepted, matching
+    // hash is enough to trust them unless -checkblockreadpow is set
+    bool fCheckPoW = fCheckBlockReadPoW || !pindex->IsValid(BLOCK_VALID_TREE);
+    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), fCheckPoW, consensusParams))
         return false;
 
     if (block.GetHash() != pindex->GetBlockHash()) {
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
                      pindex->ToString(), pindex->GetBlockPos().ToString());
     }
+
+    // Spare VerifyDB and others from hashing the header again. cs_main is only tried, the thread
+    // holding it may wait for readers on other threads, such as those of the Exodus initial scan
+    if (!fCheckPoW) {
+        TRY_LOCK(cs_main, lockMain);
+        if (lockMain)
+            block.SetPoWHash(pindex->GetBlockPoWHash());
+    }
     return true;
 }
 
@@ -2516,32 +2532,6 @@ namespace {
         return true;
     }
 
-    bool UndoReadFromDisk(CBlockUndo &blockundo, const CDiskBlockPos &pos, const uint256 &hashBlock) {
-        // Open history file to read
-        CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
-        if (filein.IsNull())
-            return error("%s: OpenUndoFile failed", __func__);
-
-        // Read block
-        uint256 hashChecksum;
-        try {
-            filein >> blockundo;
-            filein >> hashChecksum;
-        }
-        catch (const std::exception &e) {
-            return error("%s: Deserialize or I/O error - %s", __func__, e.what());
-        }
-
-        // Verify checksum
-        CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
-        hasher << hashBlock;
-        hasher << blockundo;
-        if (hashChecksum != hasher.GetHash())
-            return error("%s: Checksum mismatch", __func__);
-
-        return true;
-    }
-
 /** Abort with a message */
     /*bool AbortNode(const std::string &strMessage, const std::string &userMessage = "") {
         strMiscWarning = strMessage;
@@ -2561,6 +2551,32 @@ namespace {
 
 } // anon namespace
 
+bool UndoReadFromDisk(CBlockUndo &blockundo, const CDiskBlockPos &pos, const uint256 &hashBlock) {
+    // Open history file to read
+    CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: OpenUndoFile failed", __func__);
+
+    // Read block
+    uint256 hashChecksum;
+    try {
+        filein >> blockundo;
+        filein >> hashChecksum;
+    }
+    catch (const std::exception &e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    // Verify checksum
+    CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
+    hasher << hashBlock;
+    hasher << blockundo;
+    if (hashChecksum != hasher.GetHash())
+        return error("%s: Checksum mismatch", __func__);
+
+    return true;
+}
+
 /**
  * Apply the undo operation of a CTxInUndo to the given chain state.
  * @param undo The undo object.
@@ -2718,13 +2734,17 @@ void static FlushBlockFile(bool fFinalize = false) {
 
 bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos, unsigned int nAddSize);
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+static CCheckQueue<CVerificationCheck> scriptcheckqueue(128);
 
 void ThreadScriptCheck() {
     RenameThread("bitcoin-scriptch");
     scriptcheckqueue.Thread();
 }
 
+CCheckQueue<CVerificationCheck> &GetVerificationQueue() {
+    return scriptcheckqueue;
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2899,7 +2919,7 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
 
     CBlockUndo blockundo;
 
-    CCheckQueueControl<CScriptCheck> control(fScriptChecks && nScriptCheckThreads ? &scriptcheckqueue : NULL);
+    CCheckQueueControl<CVerificationCheck> control(fScriptChecks && nScriptCheckThreads ? &scriptcheckqueue : NULL);
 
     std::vector <uint256> vOrphanErase;
     std::vector<int> prevheights;
@@ -2919,6 +2939,7 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
     set<uint256> txIds;
     bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET);
     block.sigmaTxInfo = std::make_shared<sigma::CSigmaTxInfo>();
+    block.sigmaTxInfo->fBatchVerify = true;
 
     for (unsigned int i = 0; i < block.vtx.size(); i++) {
         const CTransaction &tx = block.vtx[i];
@@ -2993,7 +3014,10 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
                              nScriptCheckThreads ? &vChecks : NULL))
                 return error("ConnectBlock(): CheckInputs on %s failed with %s",
                              tx.GetHash().ToString(), FormatStateMessage(state));
-            control.Add(vChecks);
+            std::vector<CVerificationCheck> vVerificationChecks(vChecks.size());
+            for (size_t j = 0; j < vChecks.size(); j++)
+                vVerificationChecks[j].SetScriptCheck(vChecks[j]);
+            control.Add(vVerificationChecks);
         }
 
         CTxUndo undoDummy;
@@ -3007,8 +3031,6 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
 
     }
 
-    block.sigmaTxInfo->Complete();
-
     int64_t nTime3 = GetTimeMicros();
     nTimeConnect += nTime3 - nTime2;
     LogPrint("bench", "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) [%.2fs]\n",
@@ -3042,6 +3064,12 @@ bool ConnectBlock(const CBlock &block, CValidationState &state, CBlockIndex *pin
 
     if (!control.Wait())
         return state.DoS(100, false);
+
+    // Sigma proofs are checked on the same verification threads, once the script checks are done
+    if (!sigma::CheckSigmaSpendBatch(state, block.sigmaTxInfo.get()))
+        return error("ConnectBlock(): sigma spend verification failed: %s", FormatStateMessage(state));
+
+    block.sigmaTxInfo->Complete();
     int64_t nTime4 = GetTimeMicros();
     nTimeVerify += nTime4 - nTime2;
     LogPrint("bench", "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime4 - nTime2),
@@ -3238,9 +3266,10 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
                     vBlocks.push_back(*it);
                     setDirtyBlockIndex.erase(it++);
                 }
-                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks)) {
+                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks, sigma::GetPendingSigmaBlockData())) {
                     return AbortNode(state, "Files to write to block index database");
                 }
+                sigma::ClearPendingSigmaBlockData();
             }
             // Finally remove any pruned files
             if (fFlushForPrune)
@@ -3260,6 +3289,10 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
             nLastFlush = nNow;
+            // Snapshot sigma state so the next start doesn't have to replay the whole chain. It's
+            // done once the blocks are in so it isn't rewritten on every cache flush during sync
+            if (mode == FLUSH_STATE_ALWAYS || !IsInitialBlockDownload())
+                sigma::WriteSigmaStateSnapshot(pcoinsTip->GetBestBlock());
         }
         if (fDoFullFlush || ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) &&
                              nNow > nLastSetChain + (int64_t) DATABASE_WRITE_INTERVAL * 1000000)) {
@@ -3530,7 +3563,7 @@ ConnectTip(CValidationState &state, const CChainParams &chainparams, CBlockIndex
     //! Exodus: begin block connect notification
     if (fExodus) {
         LogPrint("handler", "Exodus handler: block connect begin [height: %d]\n", GetHeight());
-        exodus_handler_block_begin(GetHeight(), pindexNew);
+        exodus_handler_block_begin(GetHeight(), pindexNew, pblock);
     }
 
     // Remove conflicting transactions from the mempool.
@@ -4379,6 +4412,10 @@ bool CheckBlock(const CBlock &block, CValidationState &state,
         if (block.sigmaTxInfo == NULL)
             block.sigmaTxInfo = std::make_shared<sigma::CSigmaTxInfo>();
 
+        // Sigma proofs sharing an anonymity set are verified together after all the transactions
+        block.sigmaTxInfo->fBatchVerify = true;
+        block.sigmaTxInfo->pendingSpends.clear();
+
         BOOST_FOREACH(const CTransaction &tx, block.vtx)
         if (!CheckTransaction(tx, state, tx.GetHash(), isVerifyDB, nHeight, false, block.sigmaTxInfo.get())) {
             LogPrintf("block=%s\n", block.ToString());
@@ -4387,6 +4424,11 @@ bool CheckBlock(const CBlock &block, CValidationState &state,
                                            state.GetDebugMessage()));
         }
 
+        if (!sigma::CheckSigmaSpendBatch(state, block.sigmaTxInfo.get())) {
+            return state.Invalid(false, state.GetRejectCode(), state.GetRejectReason(),
+                                 strprintf("Sigma spend check failed %s", state.GetDebugMessage()));
+        }
+
         block.sigmaTxInfo->Complete();
 
         unsigned int nSigOps = 0;
@@ -4650,6 +4692,8 @@ static bool AcceptBlockHeader(const CBlockHeader &block, CValidationState &state
             if (pindex->nStatus & BLOCK_FAILED_MASK)
                 return state.Invalid(error("%s: block %s is marked invalid", __func__, hash.ToString()), 0,
                                      "duplicate");
+            // the header is the same, CheckBlock of a block accepted again doesn't need to hash it
+            block.SetPoWHash(pindex->GetBlockPoWHash());
             return true;
         }
 //        int nHeight = ZerocoinGetNHeight(block);
@@ -4778,6 +4822,7 @@ static bool IsSuperMajority(int minVersion, const CBlockIndex *pstart, unsigned
 
 bool ProcessNewBlock(CValidationState &state, const CChainParams &chainparams, CNode *pfrom, const CBlock *pblock,
                      bool fForceProcessing, const CDiskBlockPos *dbp, bool fMayBanPeerIfInvalid) {
+    CPoWHashScope powHashScope;
     int nHeight = ZerocoinGetNHeight(pblock->GetBlockHeader());
     LogPrintf("ProcessNewBlock nHeight=%s, blockHash:%s\n", nHeight, pblock->GetHash().ToString());
     //    LogPrint("ProcessNewBlock", "block=%s", pblock->ToString());
@@ -5129,7 +5174,8 @@ bool static LoadBlockIndexDB() {
 
     // some blocks in index can change as a result of SigmaBuildStateFromIndex() call
     set<CBlockIndex *> changes;
-    sigma::BuildSigmaStateFromIndex(&chainActive);
+    if (!sigma::BuildSigmaStateFromIndex(&chainActive))
+        return error("%s: failed to load sigma state", __func__);
     if (!changes.empty()) {
         setDirtyBlockIndex.insert(changes.begin(), changes.end());
         FlushStateToDisk();
@@ -5154,6 +5200,7 @@ CVerifyDB::~CVerifyDB() {
 
 bool CVerifyDB::VerifyDB(const CChainParams &chainparams, CCoinsView *coinsview, int nCheckLevel, int nCheckDepth) {
     LOCK(cs_main);
+    CPoWHashScope powHashScope;
     if (chainActive.Tip() == NULL || chainActive.Tip()->pprev == NULL)
         return true;
 
@@ -5193,6 +5240,9 @@ bool CVerifyDB::VerifyDB(const CChainParams &chainparams, CCoinsView *coinsview,
         if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus()))
             return error("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight,
                          pindex->GetBlockHash().ToString());
+        // blocks read with a proof of work check still get the hash kept in the index
+        if (!block.HasPoWHash())
+            block.SetPoWHash(pindex->GetBlockPoWHash());
         LogPrintf("VerifyDB->CheckBlock() nHeight=%s\n", pindex->nHeight);
         // check level 1: verify block validity
         if (nCheckLevel >= 1 &&
@@ -5364,6 +5414,7 @@ void UnloadBlockIndex() {
     nPreferredDownload = 0;
     setDirtyBlockIndex.clear();
     setDirtyFileInfo.clear();
+    sigma::ClearPendingSigmaBlockData();
     mapNodeState.clear();
     recentRejects.reset(NULL);
     versionbitscache.Clear();
@@ -5443,6 +5494,7 @@ bool LoadExternalBlockFile(const CChainParams &chainparams, FILE *fileIn, CDiskB
     LogPrintf("LoadExternalBlockFile...\n");
     static std::multimap <uint256, CDiskBlockPos> mapBlocksUnknownParent;
     int64_t nStart = GetTimeMillis();
+    CPoWHashScope powHashScope;
 
     int nLoaded = 0;
     try {
@@ -7441,6 +7493,7 @@ bool static ProcessMessage(CNode *pfrom, string strCommand,
 
             LogPrint("net", "ProcessMessage.AcceptBlockHeader() total %s blocks\n", headers.size());
             CBlockIndex *pindexLast = NULL;
+            CPoWHashScope powHashScope;
             BOOST_FOREACH(
             const CBlockHeader &header, headers) {
                 CValidationState state;
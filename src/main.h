@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <exception>
+#include <functional>
 #include <map>
 #include <set>
 #include <stdint.h>
@@ -37,6 +38,7 @@
 
 class CBlockIndex;
 class CBlockTreeDB;
+class CBlockUndo;
 class CBloomFilter;
 class CChainParams;
 class CInv;
@@ -142,6 +144,8 @@ static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 /** Default for -permitbaremultisig */
 static const bool DEFAULT_PERMIT_BAREMULTISIG = true;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
+/** Default for -checkblockreadpow */
+static const bool DEFAULT_CHECK_BLOCK_READ_POW = false;
 static const bool DEFAULT_TXINDEX = true;
 static const bool DEFAULT_TIMESTAMPINDEX = false;
 static const bool DEFAULT_ADDRESSINDEX = false;
@@ -191,6 +195,8 @@ extern bool fTxIndex;
 extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
+/** Recompute proof of work of every block read from disk, even if it's already in the block index */
+extern bool fCheckBlockReadPoW;
 extern bool fCheckpointsEnabled;
 extern int nScriptCheckThreads;
 //extern int nBestHeight;
@@ -490,6 +496,39 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Work item of the verification threads: either a script check or another verification,
+ * such as a batch of sigma proofs, so that both share the threads controlled by -par.
+ */
+class CVerificationCheck
+{
+private:
+    CScriptCheck scriptCheck;
+    //! Run instead of the script check, if set
+    std::function<bool()> check;
+
+public:
+    CVerificationCheck() {}
+    explicit CVerificationCheck(std::function<bool()> checkIn) : check(std::move(checkIn)) {}
+
+    bool operator()() { return check ? check() : scriptCheck(); }
+
+    void SetScriptCheck(CScriptCheck &scriptCheckIn) {
+        scriptCheck.swap(scriptCheckIn);
+        check = nullptr;
+    }
+
+    void swap(CVerificationCheck &other) {
+        scriptCheck.swap(other.scriptCheck);
+        check.swap(other.check);
+    }
+};
+
+template <typename T> class CCheckQueue;
+
+/** Queue of the verification threads. Only one CCheckQueueControl may use it at a time, callers hold cs_main. */
+CCheckQueue<CVerificationCheck> &GetVerificationQueue();
+
 bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes);
 bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
 bool GetAddressIndex(uint160 addressHash, AddressType type,
@@ -502,6 +541,7 @@ bool GetAddressUnspent(uint160 addressHash, AddressType type,
 bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, int nHeight, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashBlock);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -27,6 +27,7 @@
 #include "validationinterface.h"
 #include "wallet/wallet.h"
 #include "definition.h"
+#include "crypto/common.h"
 #include "crypto/scrypt.h"
 #include "crypto/Lyra2Z/Lyra2Z.h"
 #include "crypto/Lyra2Z/Lyra2.h"
@@ -1027,11 +1028,86 @@ static bool ProcessBlockFound(const CBlock* pblock, const CChainParams& chainpar
     return true;
 }
 
-void static GravityCoinMiner(const CChainParams &chainparams) {
+namespace {
+
+/** Hashes per second of each miner thread, indexed by thread number */
+CCriticalSection cs_minerHashRates;
+std::vector<double> vMinerHashRates;
+
+/**
+ * Evaluates several consecutive nonces of a block header at once. Every lane owns a Lyra2Z matrix,
+ * the lanes are interleaved so the memory accesses of one hash overlap with the work on the others.
+ */
+class CLyra2ZLaneHasher
+{
+private:
+    lyra2z_ctx ctx[LYRA2_MAX_LANES];
+    unsigned int nLanes;
+    unsigned char headers[LYRA2_MAX_LANES * 80];
+    uint256 hashes[LYRA2_MAX_LANES];
+
+public:
+    CLyra2ZLaneHasher(int nLanesIn) {
+        nLanes = std::max(1, std::min(nLanesIn, (int)LYRA2_MAX_LANES));
+        bool fHugePages = GetBoolArg("-lyra2zhugepages", DEFAULT_LYRA2Z_HUGE_PAGES);
+        for (unsigned int i = 0; i < nLanes; i++) {
+            if (lyra2z_ctx_init(&ctx[i], 330, 256, fHugePages) != 0) {
+                // Run with the matrices we got, GetPoWHash() is used if none
+                LogPrintf("CLyra2ZLaneHasher: could only allocate %u of %u lanes\n", i, nLanes);
+                nLanes = i;
+                break;
+            }
+        }
+    }
+
+    ~CLyra2ZLaneHasher() {
+        for (unsigned int i = 0; i < nLanes; i++)
+            lyra2z_ctx_free(&ctx[i]);
+    }
+
+    /** Number of nonces evaluated by each call to Hash() */
+    unsigned int Lanes() const { return std::max(nLanes, 1u); }
+
+    /** Computes the PoW hashes of header with nonces header.nNonce ... header.nNonce + Lanes() - 1 */
+    const uint256* Hash(const CBlockHeader& header) {
+        if (nLanes == 0) {
+            hashes[0] = header.GetPoWHash();
+            return hashes;
+        }
+        for (unsigned int i = 0; i < nLanes; i++) {
+            memcpy(headers + i * 80, BEGIN(header.nVersion), 80);
+            WriteLE32(headers + i * 80 + 76, header.nNonce + i);
+        }
+        lyra2z_ctx_hash_lanes(ctx, nLanes, BEGIN(hashes[0]), 32, headers, 80, headers, 80, 2);
+        return hashes;
+    }
+};
+
+void UpdateMinerHashRate(int nThread, double dHashesPerSec) {
+    LOCK(cs_minerHashRates);
+    if (nThread < (int)vMinerHashRates.size())
+        vMinerHashRates[nThread] = dHashesPerSec;
+}
+
+}
+
+std::vector<double> GetMinerThreadHashRates()
+{
+    LOCK(cs_minerHashRates);
+    return vMinerHashRates;
+}
+
+void static GravityCoinMiner(const CChainParams &chainparams, int nThread) {
     SetThreadPriority(THREAD_PRIORITY_LOWEST);
     RenameThread("gravitycoin-miner");
 
     unsigned int nExtraNonce = 0;
+    CLyra2ZLaneHasher hasher(GetArg("-minerlanes", DEFAULT_MINER_LANES));
+    // used by GetPoWHash() when no lane could be allocated
+    CPoWHashScope powHashScope;
+    const unsigned int nLanes = hasher.Lanes();
+    int64_t nHashRateStart = GetTimeMicros();
+    uint64_t nHashesDone = 0;
 
     boost::shared_ptr<CReserveScript> coinbaseScript;
     GetMainSignals().ScriptForMining(coinbaseScript);
@@ -1105,8 +1181,15 @@ void static GravityCoinMiner(const CChainParams &chainparams) {
                 uint256 thash;
 
                 while (true) {
-                    LYRA2(BEGIN(thash), 32, BEGIN(pblock->nVersion), 80, BEGIN(pblock->nVersion), 80, 2, 330, 256);
-                    if (UintToArith256(thash) <= hashTarget) {
+                    const uint256* hashes = hasher.Hash(*pblock);
+                    nHashesDone += nLanes;
+                    unsigned int nLane = 0;
+                    while (nLane < nLanes && UintToArith256(hashes[nLane]) > hashTarget)
+                        nLane++;
+                    if (nLane < nLanes) {
+                        pblock->nNonce += nLane;
+                        thash = hashes[nLane];
+                        pblock->SetPoWHash(thash);
                         // Found a solution
                         LogPrintf("Found a solution. Hash: %s", UintToArith256(thash).ToString());
                         SetThreadPriority(THREAD_PRIORITY_NORMAL);
@@ -1120,10 +1203,16 @@ void static GravityCoinMiner(const CChainParams &chainparams) {
                             throw boost::thread_interrupted();
                         break;
                     }
-                    pblock->nNonce += 1;
-                    if ((pblock->nNonce & 0xFF) == 0)
+                    pblock->nNonce += nLanes;
+                    if ((pblock->nNonce & 0xFF) < nLanes)
                         break;
                 }
+                int64_t nNow = GetTimeMicros();
+                if (nNow - nHashRateStart >= 1000000) {
+                    UpdateMinerHashRate(nThread, nHashesDone * 1e6 / (nNow - nHashRateStart));
+                    nHashRateStart = nNow;
+                    nHashesDone = 0;
+                }
                 // Check for stop or if block needs to be rebuilt
                 boost::this_thread::interruption_point();
                 // Regtest mode doesn't require peers
@@ -1171,12 +1260,17 @@ void GenerateBitcoins(bool fGenerate, int nThreads, const CChainParams& chainpar
         minerThreads = NULL;
     }
 
+    {
+        LOCK(cs_minerHashRates);
+        vMinerHashRates.assign(fGenerate ? std::max(nThreads, 0) : 0, 0.0);
+    }
+
     if (nThreads == 0 || !fGenerate)
         return;
 
     minerThreads = new boost::thread_group();
     for (int i = 0; i < nThreads; i++)
-        minerThreads->create_thread(boost::bind(&GravityCoinMiner, boost::cref(chainparams)));
+        minerThreads->create_thread(boost::bind(&GravityCoinMiner, boost::cref(chainparams), i));
 }
 
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce)
@@ -24,6 +24,8 @@ namespace Consensus { struct Params; };
 
 static const bool DEFAULT_GENERATE = false;
 static const int DEFAULT_GENERATE_THREADS = 1;
+/** Default for -minerlanes, the number of nonces each miner thread hashes at once */
+static const int DEFAULT_MINER_LANES = 2;
 
 static const bool DEFAULT_PRINTPRIORITY = false;
 
@@ -214,5 +216,7 @@ void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
 /** Run the miner threads */
 void GenerateBitcoins(bool fGenerate, int nThreads, const CChainParams& chainparams);
+/** Hashes per second of each running miner thread */
+std::vector<double> GetMinerThreadHashRates();
 
 #endif // BITCOIN_MINER_H
@@ -21,17 +21,117 @@
 #include <algorithm>
 #include <string>
 
+#include <boost/thread/tss.hpp>
+
+namespace {
+
+/** Lyra2Z matrix of the calling thread, allocated on first use within a CPoWHashScope */
+class CLyra2ZContext
+{
+private:
+    lyra2z_ctx ctx;
+    bool fAllocated;
+    bool fFailed;
+
+public:
+    //! Number of nested scopes on the thread
+    int nScopes;
+
+    CLyra2ZContext() : fAllocated(false), fFailed(false), nScopes(0) {}
+
+    ~CLyra2ZContext() {
+        if (fAllocated)
+            lyra2z_ctx_free(&ctx);
+    }
+
+    lyra2z_ctx* Get() {
+        if (!fAllocated && !fFailed) {
+            fAllocated = lyra2z_ctx_init(&ctx, 330, 256, GetBoolArg("-lyra2zhugepages", DEFAULT_LYRA2Z_HUGE_PAGES)) == 0;
+            fFailed = !fAllocated;
+        }
+        return fAllocated ? &ctx : NULL;
+    }
+};
+
+boost::thread_specific_ptr<CLyra2ZContext> lyra2zContext;
+
+}
+
+CPoWHashScope::CPoWHashScope() {
+    if (!lyra2zContext.get())
+        lyra2zContext.reset(new CLyra2ZContext());
+    lyra2zContext->nScopes++;
+}
+
+CPoWHashScope::~CPoWHashScope() {
+    if (--lyra2zContext->nScopes == 0)
+        lyra2zContext.reset();
+}
 
 uint256 CBlockHeader::GetHash() const {
     return SerializeHash(*this);
 }
 
+CBlockHeader& CBlockHeader::operator=(const CBlockHeader &other) {
+    nVersion       = other.nVersion;
+    hashPrevBlock  = other.hashPrevBlock;
+    hashMerkleRoot = other.hashMerkleRoot;
+    nTime          = other.nTime;
+    nBits          = other.nBits;
+    nNonce         = other.nNonce;
+
+    // the copy isn't shared yet, the cached hash of the other header doesn't change once it is ready
+    if (other.nPoWHashState.load(std::memory_order_acquire) == POW_HASH_READY) {
+        powHash = other.powHash;
+        powHashHeader = other.powHashHeader;
+        nPoWHashState.store(POW_HASH_READY, std::memory_order_release);
+    } else {
+        powHash.SetNull();
+        powHashHeader.SetNull();
+        nPoWHashState.store(POW_HASH_EMPTY, std::memory_order_release);
+    }
+    return *this;
+}
+
+bool CBlockHeader::GetCachedPoWHash(const uint256 &headerHash, uint256 &hash) const {
+    if (nPoWHashState.load(std::memory_order_acquire) != POW_HASH_READY || powHashHeader != headerHash)
+        return false;
+    hash = powHash;
+    return true;
+}
+
+void CBlockHeader::CachePoWHash(const uint256 &headerHash, const uint256 &hash) const {
+    // only the first hash is kept, headers changed afterwards (e.g. by the miner) are hashed again
+    int expected = POW_HASH_EMPTY;
+    if (!nPoWHashState.compare_exchange_strong(expected, POW_HASH_WRITING, std::memory_order_acquire))
+        return;
+    powHash = hash;
+    powHashHeader = headerHash;
+    nPoWHashState.store(POW_HASH_READY, std::memory_order_release);
+}
+
 uint256 CBlockHeader::GetPoWHash() const {
+    uint256 headerHash = GetHash();
+    uint256 hash;
+    if (GetCachedPoWHash(headerHash, hash))
+        return hash;
 
-    uint256 powHash;
-    LYRA2(BEGIN(powHash), 32, BEGIN(nVersion), 80, BEGIN(nVersion), 80, 2, 330, 256);
-    return powHash;
+    lyra2z_ctx* ctx = lyra2zContext.get() ? lyra2zContext->Get() : NULL;
+    if (ctx)
+        lyra2z_ctx_hash(ctx, BEGIN(hash), 32, BEGIN(nVersion), 80, BEGIN(nVersion), 80, 2);
+    else
+        LYRA2(BEGIN(hash), 32, BEGIN(nVersion), 80, BEGIN(nVersion), 80, 2, 330, 256);
+    CachePoWHash(headerHash, hash);
+    return hash;
+}
+
+bool CBlockHeader::HasPoWHash() const {
+    uint256 hash;
+    return GetCachedPoWHash(GetHash(), hash);
+}
 
+void CBlockHeader::SetPoWHash(const uint256 &hash) const {
+    CachePoWHash(GetHash(), hash);
 }
 
 std::string CBlock::ToString() const {
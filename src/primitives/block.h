@@ -6,6 +6,7 @@
 #ifndef BITCOIN_PRIMITIVES_BLOCK_H
 #define BITCOIN_PRIMITIVES_BLOCK_H
 
+#include <atomic>
 #include <deque>
 #include <type_traits>
 #include <boost/foreach.hpp>
@@ -21,6 +22,22 @@ class CSigmaTxInfo;
 
 } // namespace sigma.
 
+/** Default for -lyra2zhugepages */
+static const bool DEFAULT_LYRA2Z_HUGE_PAGES = false;
+
+/**
+ * Keeps a Lyra2Z matrix for the proof of work hashes computed by the current thread while it
+ * exists, so that validation and mining don't allocate the matrix for every hash. Scopes may be
+ * nested, the matrix is released when the outermost one ends. Outside of a scope every hash
+ * allocates its own matrix.
+ */
+class CPoWHashScope
+{
+public:
+    CPoWHashScope();
+    ~CPoWHashScope();
+};
+
 inline int GetZerocoinChainID()
 {
     return 0x0001; // We are the first :)
@@ -40,14 +57,32 @@ public:
     static const int CURRENT_VERSION = 2;
 
     // uint32_t lastHeight;
-    uint256 powHash;
-    int32_t isComputed;
 
+private:
+    // memory only, proof of work hash and hash of the header it was computed for. Headers are shared
+    // between threads, so the hash is written once, by the thread which moves nPoWHashState from
+    // POW_HASH_EMPTY to POW_HASH_WRITING, and only read once the state is POW_HASH_READY
+    enum { POW_HASH_EMPTY, POW_HASH_WRITING, POW_HASH_READY };
+    mutable std::atomic<int> nPoWHashState;
+    mutable uint256 powHash;
+    mutable uint256 powHashHeader;
+
+    bool GetCachedPoWHash(const uint256 &headerHash, uint256 &hash) const;
+    void CachePoWHash(const uint256 &headerHash, const uint256 &hash) const;
+
+public:
     CBlockHeader()
     {
         SetNull();
     }
 
+    CBlockHeader(const CBlockHeader &other)
+    {
+        *this = other;
+    }
+
+    CBlockHeader& operator=(const CBlockHeader &other);
+
     ADD_SERIALIZE_METHODS;
 
     class CSerializeBlockHeader {};
@@ -82,8 +117,9 @@ public:
         nTime = 0;
         nBits = 0;
         nNonce = 0;
-        isComputed = -1;
         powHash.SetNull();
+        powHashHeader.SetNull();
+        nPoWHashState.store(POW_HASH_EMPTY, std::memory_order_relaxed);
     }
 
     int GetChainID() const
@@ -96,13 +132,15 @@ public:
         return (nBits == 0);
     }
 
-    bool IsComputed() const
-    {
-        return (isComputed <= 0);
-    }
-
+    //! Lyra2Z hash of the header, computed once as long as the header doesn't change
     uint256 GetPoWHash() const;
 
+    //! Returns true if proof of work hash of the current header is known without hashing
+    bool HasPoWHash() const;
+
+    //! Set proof of work hash of the current header, known from the block index, unless one is cached already
+    void SetPoWHash(const uint256 &hash) const;
+
     uint256 GetHash() const;
 
     int64_t GetBlockTime() const
@@ -165,15 +203,8 @@ public:
 
     CBlockHeader GetBlockHeader() const
     {
-        CBlockHeader block;
-        block.nVersion       = nVersion;
-        block.hashPrevBlock  = hashPrevBlock;
-        block.hashMerkleRoot = hashMerkleRoot;
-        block.nTime          = nTime;
-        block.nBits          = nBits;
-        block.nNonce         = nNonce;
-
-        return block;
+        // the header fields, and the proof of work hash if it is known
+        return CBlockHeader(*this);
     }
 
     std::string ToString() const;
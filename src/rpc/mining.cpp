@@ -301,6 +301,11 @@ UniValue getmininginfo(const UniValue& params, bool fHelp)
             "  \"errors\": \"...\"            (string) Current errors\n"
             "  \"generate\": true|false     (boolean) If the generation is on or off (see getgenerate or setgenerate calls)\n"
             "  \"genproclimit\": n          (numeric) The processor limit for generation. -1 if no generation. (see getgenerate or setgenerate calls)\n"
+            "  \"hashespersec\": nnn,       (numeric) The hashes per second of the built-in miner\n"
+            "  \"threadhashespersec\": [    (array) The hashes per second of each miner thread\n"
+            "     nnn,                    (numeric) The hashes per second of the thread\n"
+            "     ...\n"
+            "  ],\n"
             "  \"networkhashps\": nnn,      (numeric) The network hashes per second\n"
             "  \"pooledtx\": n              (numeric) The size of the mempool\n"
             "  \"testnet\": true|false      (boolean) If using testnet or not\n"
@@ -323,6 +328,15 @@ UniValue getmininginfo(const UniValue& params, bool fHelp)
     obj.push_back(Pair("errors",           GetWarnings("statusbar")));
     obj.push_back(Pair("genproclimit",     (int)GetArg("-genproclimit", DEFAULT_GENERATE_THREADS)));
 
+    double dHashesPerSec = 0;
+    UniValue threadRates(UniValue::VARR);
+    BOOST_FOREACH(double dThreadRate, GetMinerThreadHashRates()) {
+        dHashesPerSec += dThreadRate;
+        threadRates.push_back(dThreadRate);
+    }
+    obj.push_back(Pair("hashespersec",     dHashesPerSec));
+    obj.push_back(Pair("threadhashespersec", threadRates));
+
     obj.push_back(Pair("networkhashps",    getnetworkhashps(params, false)));
     obj.push_back(Pair("pooledtx",         (uint64_t)mempool.size()));
     obj.push_back(Pair("testnet",          Params().TestnetToBeDeprecatedFieldRPC()));
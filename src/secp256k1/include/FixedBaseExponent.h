@@ -0,0 +1,34 @@
+#ifndef SECP_FIXEDBASEEXPONENT_H
+#define SECP_FIXEDBASEEXPONENT_H
+
+#include "../include/GroupElement.h"
+#include "../include/Scalar.h"
+
+namespace secp_primitives {
+
+// Multiples of a fixed base precomputed for every window of the scalar, so multiplication by a scalar
+// takes one point addition per window and no doublings. Meant for generators used over and over again.
+class FixedBaseExponent {
+public:
+    explicit FixedBaseExponent(const GroupElement& base);
+    FixedBaseExponent(FixedBaseExponent&& other);
+    ~FixedBaseExponent();
+
+    FixedBaseExponent(const FixedBaseExponent&) = delete;
+    FixedBaseExponent& operator=(const FixedBaseExponent&) = delete;
+
+    const GroupElement& get_base() const;
+
+    GroupElement get_multiple(const Scalar& power) const;
+
+    // result += base * power
+    void add_multiple(GroupElement& result, const Scalar& power) const;
+
+private:
+    GroupElement base_;
+    void *table_; // secp256k1_ge_storage[], NULL if the base is the point at infinity
+};
+
+}// namespace secp_primitives
+
+#endif //SECP_FIXEDBASEEXPONENT_H
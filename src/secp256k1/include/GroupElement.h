@@ -52,6 +52,8 @@ public:
 
   bool isMember() const;
 
+  bool isInfinity() const;
+
   GroupElement& generate(unsigned char* seed);
 
   void sha256(unsigned char* result) const;
@@ -103,7 +105,15 @@ public:
 
   GroupElement& set_base_g();
 
+  // Converts the point to affine coordinates, so comparing, hashing and serializing
+  // it later does not need a field inversion.
+  GroupElement& normalize();
+
+  // Normalizes all the points with a single field inversion (Montgomery's trick).
+  static void normalize_batch(const std::vector<GroupElement*>& points);
+
   friend class MultiExponent;
+  friend class FixedBaseExponent;
 private:
     // Returns the secp object inside it.
     const void * get_value() const;
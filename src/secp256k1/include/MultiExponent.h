@@ -7,17 +7,25 @@
 
 namespace secp_primitives {
 
+/**
+ * Computes sum(generators[i] * powers[i]).
+ *
+ * The points and scalars are borrowed, not copied, so they must stay alive
+ * until get_multiple() returns. Scratch memory for the Strauss/Pippenger
+ * algorithms is kept per thread and reused between calls.
+ */
 class MultiExponent {
 public:
     MultiExponent(const MultiExponent& other);
     MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers);
+    MultiExponent(const GroupElement* generators, const Scalar* powers, size_t n);
     ~MultiExponent();
 
     GroupElement get_multiple();
 
 private:
-    void  *sc_; // secp256k1_scalar[]
-    void  *pt_; // secp256k1_gej[]
+    const GroupElement *pt_;
+    const Scalar *sc_;
     int n_points;
 };
 
@@ -0,0 +1,89 @@
+#include "../include/FixedBaseExponent.h"
+
+#include "../include/secp256k1.h"
+#include "../field.h"
+#include "../field_impl.h"
+#include "../group.h"
+#include "../group_impl.h"
+#include "../scalar.h"
+#include "../scalar_impl.h"
+
+#include <vector>
+
+// Bits of the scalar handled by one table row, the row holds 1..2^w-1 multiples of 2^(w*row) * base
+static const unsigned int FIXED_BASE_WINDOW = 6;
+static const unsigned int FIXED_BASE_ROWS = (256 + FIXED_BASE_WINDOW - 1) / FIXED_BASE_WINDOW;
+static const unsigned int FIXED_BASE_ROW_SIZE = (1 << FIXED_BASE_WINDOW) - 1;
+
+namespace secp_primitives {
+
+FixedBaseExponent::FixedBaseExponent(const GroupElement& base)
+        : base_(base)
+        , table_(NULL)
+{
+    if (base.isInfinity())
+        return;
+
+    const size_t n_points = FIXED_BASE_ROWS * FIXED_BASE_ROW_SIZE;
+    std::vector<secp256k1_gej> points(n_points);
+    secp256k1_gej row_base = *reinterpret_cast<const secp256k1_gej *>(base.get_value());
+    for (unsigned int i = 0; i < FIXED_BASE_ROWS; ++i) {
+        secp256k1_gej *row = &points[i * FIXED_BASE_ROW_SIZE];
+        row[0] = row_base;
+        for (unsigned int j = 1; j < FIXED_BASE_ROW_SIZE; ++j)
+            secp256k1_gej_add_var(&row[j], &row[j - 1], &row_base, NULL);
+        // (2^w - 1) * row_base + row_base is the base of the next row
+        secp256k1_gej_add_var(&row_base, &row[FIXED_BASE_ROW_SIZE - 1], &row_base, NULL);
+    }
+
+    std::vector<secp256k1_ge> affine(n_points);
+    secp256k1_ge_set_all_gej_var(affine.data(), points.data(), n_points, NULL);
+
+    secp256k1_ge_storage *table = new secp256k1_ge_storage[n_points];
+    for (size_t i = 0; i < n_points; ++i)
+        secp256k1_ge_to_storage(&table[i], &affine[i]);
+    table_ = table;
+}
+
+FixedBaseExponent::FixedBaseExponent(FixedBaseExponent&& other)
+        : base_(other.base_)
+        , table_(other.table_)
+{
+    other.table_ = NULL;
+}
+
+FixedBaseExponent::~FixedBaseExponent(){
+    delete []reinterpret_cast<secp256k1_ge_storage *>(table_);
+}
+
+const GroupElement& FixedBaseExponent::get_base() const {
+    return base_;
+}
+
+GroupElement FixedBaseExponent::get_multiple(const Scalar& power) const {
+    GroupElement result;
+    add_multiple(result, power);
+    return result;
+}
+
+void FixedBaseExponent::add_multiple(GroupElement& result, const Scalar& power) const {
+    if (table_ == NULL)
+        return;
+
+    const secp256k1_ge_storage *table = reinterpret_cast<const secp256k1_ge_storage *>(table_);
+    const secp256k1_scalar *s = reinterpret_cast<const secp256k1_scalar *>(power.get_value());
+    secp256k1_gej *r = reinterpret_cast<secp256k1_gej *>(result.g_);
+    secp256k1_ge p;
+
+    for (unsigned int i = 0; i < FIXED_BASE_ROWS; ++i) {
+        unsigned int offset = i * FIXED_BASE_WINDOW;
+        unsigned int count = offset + FIXED_BASE_WINDOW > 256 ? 256 - offset : FIXED_BASE_WINDOW;
+        unsigned int digit = secp256k1_scalar_get_bits_var(s, offset, count);
+        if (digit != 0) {
+            secp256k1_ge_from_storage(&p, &table[i * FIXED_BASE_ROW_SIZE + digit - 1]);
+            secp256k1_gej_add_ge_var(r, r, &p, NULL);
+        }
+    }
+}
+
+}// namespace secp_primitives
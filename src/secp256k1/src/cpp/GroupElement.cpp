@@ -23,10 +23,29 @@
 
 static secp256k1_ecmult_context ctx;
 
+static const secp256k1_fe fe_one = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1);
+
+// Returns true if the point is already in affine coordinates, z == 1.
+static bool gej_is_affine(const secp256k1_gej &gej)
+{
+    secp256k1_fe z(gej.z);
+    secp256k1_fe_normalize_var(&z);
+    return secp256k1_fe_cmp_var(&z, &fe_one) == 0;
+}
+
 // Converts the value from secp256k1_gej to secp256k1_ge and returns.
+// Affine points, like deserialized or normalized ones, do not need the field inversion.
 static secp256k1_ge gej_to_ge(const secp256k1_gej &gej)
 {
     secp256k1_ge ge;
+    if (!gej.infinity && gej_is_affine(gej)) {
+        ge.x = gej.x;
+        ge.y = gej.y;
+        ge.infinity = 0;
+        secp256k1_fe_normalize_weak(&ge.x);
+        secp256k1_fe_normalize_weak(&ge.y);
+        return ge;
+    }
     secp256k1_gej j(gej);
     secp256k1_ge_set_gej(&ge, &j);
     return ge;
@@ -331,6 +350,11 @@ bool GroupElement::isMember() const
     return secp256k1_ge_is_valid_var(&v1);
 }
 
+bool GroupElement::isInfinity() const
+{
+    return secp256k1_gej_is_infinity(reinterpret_cast<secp256k1_gej *>(g_));
+}
+
 void GroupElement::randomize() {
     unsigned char temp[32] = { 0 };
 
@@ -539,6 +563,8 @@ std::size_t GroupElement::hash() const
     if (ge.infinity) {
         coord.fill(0);
     } else {
+        secp256k1_fe_normalize_var(&ge.x);
+        secp256k1_fe_normalize_var(&ge.y);
         secp256k1_fe_get_b32(&coord[0], &ge.x);
         secp256k1_fe_get_b32(&coord[32], &ge.y);
     }
@@ -555,4 +581,36 @@ GroupElement& GroupElement::set_base_g() {
     return *this;
 }
 
+GroupElement& GroupElement::normalize() {
+    auto g = reinterpret_cast<secp256k1_gej *>(g_);
+    if (!g->infinity && !gej_is_affine(*g)) {
+        secp256k1_ge ge;
+        // rescales g itself to z = 1
+        secp256k1_ge_set_gej(&ge, g);
+    }
+    return *this;
+}
+
+void GroupElement::normalize_batch(const std::vector<GroupElement*>& points) {
+    std::vector<secp256k1_gej> gej;
+    std::vector<GroupElement*> targets;
+    gej.reserve(points.size());
+    targets.reserve(points.size());
+    for (GroupElement* point : points) {
+        auto g = reinterpret_cast<secp256k1_gej *>(point->g_);
+        if (!g->infinity && !gej_is_affine(*g)) {
+            gej.push_back(*g);
+            targets.push_back(point);
+        }
+    }
+    if (gej.empty())
+        return;
+
+    std::vector<secp256k1_ge> ge(gej.size());
+    secp256k1_ge_set_all_gej_var(ge.data(), gej.data(), gej.size(), NULL);
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        secp256k1_gej_set_ge(reinterpret_cast<secp256k1_gej *>(targets[i]->g_), &ge[i]);
+    }
+}
+
 } // namespace secp_primitives
@@ -14,70 +14,83 @@
 
 
 typedef struct {
-    secp256k1_scalar *sc;
-    secp256k1_gej *pt;
+    const secp_primitives::Scalar *sc;
+    const secp_primitives::GroupElement *pt;
 } ecmult_multi_data;
 
-int ecmult_multi_callback(secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, void *cbdata) {
-    ecmult_multi_data *data = (ecmult_multi_data*) cbdata;
-    *sc = data->sc[idx];
-    *pt = data->pt[idx];
-    return 1;
-}
+namespace {
+
+// Scratch space owned by the current thread. Its frames only grow, so after the
+// first large multiexponentiation later ones of the same size allocate nothing.
+struct ThreadScratch {
+    secp256k1_scratch *scratch;
+
+    ThreadScratch() : scratch(secp256k1_scratch_create(NULL, 0)) {}
+    ~ThreadScratch() { secp256k1_scratch_destroy(scratch); }
+};
+
+thread_local ThreadScratch threadScratch;
+
+} // namespace
 
 namespace secp_primitives {
 
 MultiExponent::MultiExponent(const MultiExponent& other)
-        : sc_(new secp256k1_scalar[other.n_points])
-        , pt_(new secp256k1_gej[other.n_points])
+        : pt_(other.pt_)
+        , sc_(other.sc_)
         , n_points(other.n_points)
 {
-    for(int i = 0; i < n_points; ++i)
-    {
-        (reinterpret_cast<secp256k1_scalar *>(sc_))[i] = (reinterpret_cast<secp256k1_scalar *>(other.sc_))[i];
-        (reinterpret_cast<secp256k1_gej *>(pt_))[i] = (reinterpret_cast<secp256k1_gej *>(other.pt_))[i];
-    }
 }
 
-MultiExponent::MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers){
-    sc_ = new secp256k1_scalar[powers.size()];
-    pt_ = new secp256k1_gej[generators.size()];
-    n_points = generators.size();
-    for(int i = 0; i < n_points; ++i)
-    {
-        (reinterpret_cast<secp256k1_scalar *>(sc_))[i] = *reinterpret_cast<const secp256k1_scalar *>(powers[i].get_value());
-        (reinterpret_cast<secp256k1_gej *>(pt_))[i] = *reinterpret_cast<const secp256k1_gej *>(generators[i].get_value());
-    }
+MultiExponent::MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers)
+        : pt_(generators.data())
+        , sc_(powers.data())
+        , n_points(generators.size())
+{
+}
+
+MultiExponent::MultiExponent(const GroupElement* generators, const Scalar* powers, size_t n)
+        : pt_(generators)
+        , sc_(powers)
+        , n_points(n)
+{
 }
 
 MultiExponent::~MultiExponent(){
-    delete []reinterpret_cast<secp256k1_scalar *>(sc_);
-    delete []reinterpret_cast<secp256k1_gej *>(pt_);
 }
 
 GroupElement MultiExponent::get_multiple() {
     secp256k1_gej r;
 
     ecmult_multi_data data;
-    data.sc = reinterpret_cast<secp256k1_scalar *>(sc_);
-    data.pt = reinterpret_cast<secp256k1_gej *>(pt_);
+    data.sc = sc_;
+    data.pt = pt_;
 
-    secp256k1_scratch *scratch;
+    // Limit the scratch space to what this size needs, so the algorithm and batch
+    // split chosen by secp256k1_ecmult_multi_var do not depend on earlier calls.
+    secp256k1_scratch *scratch = threadScratch.scratch;
     if (n_points > ECMULT_PIPPENGER_THRESHOLD) {
         int bucket_window = secp256k1_pippenger_bucket_window(n_points);
         size_t scratch_size = secp256k1_pippenger_scratch_size(n_points, bucket_window);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+        scratch->max_size = scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
     } else {
         size_t scratch_size = secp256k1_strauss_scratch_size(n_points);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+        scratch->max_size = scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT;
     }
 
+    // Defined here rather than at namespace scope, as GroupElement::get_value is
+    // only accessible to MultiExponent.
+    auto ecmult_multi_callback = [](secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, void *cbdata) -> int {
+        ecmult_multi_data *data = (ecmult_multi_data*) cbdata;
+        *sc = *reinterpret_cast<const secp256k1_scalar *>(data->sc[idx].get_value());
+        *pt = *reinterpret_cast<const secp256k1_gej *>(data->pt[idx].get_value());
+        return 1;
+    };
+
     secp256k1_ecmult_context ctx;
 
     secp256k1_ecmult_multi_var(&ctx, scratch, &r, NULL, ecmult_multi_callback, &data, n_points);
 
-    secp256k1_scratch_destroy(scratch);
-
     return  reinterpret_cast<secp256k1_scalar *>(&r);
 }
 
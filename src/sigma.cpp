@@ -6,6 +6,7 @@
 #include "base58.h"
 #include "definition.h"
 #include "txmempool.h"
+#include "txdb.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "crypto/sha256.h"
@@ -14,13 +15,22 @@
 #include "xnode-payments.h"
 #include "xnode-sync.h"
 #include "sigmaentry.h"
+#include "checkqueue.h"
+#include "hash.h"
+#include "memusage.h"
+#include "random.h"
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
 #include <sstream>
 #include <chrono>
 
+#include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
 #include <boost/scope_exit.hpp>
+#include <boost/thread.hpp>
+#include <boost/unordered_set.hpp>
 
 #include <ios>
 
@@ -28,6 +38,79 @@ namespace sigma {
 
 static CSigmaState sigmaState;
 
+// Sigma data of connected blocks waiting for the next block index flush
+static std::map<const CBlockIndex*, CSigmaBlockData> mapPendingSigmaBlockData;
+
+namespace {
+
+class CSigmaProofCacheHasher
+{
+public:
+    size_t operator()(const uint256& key) const {
+        return key.GetCheapHash();
+    }
+};
+
+/**
+ * Cache of verified sigma spends, to avoid verifying the proof of every spend twice or more
+ * (once when accepted into memory pool, and again in CheckBlock and ConnectBlock)
+ */
+class CSigmaProofCache
+{
+private:
+    //! Entries are hash of nonce, spend, anonymity set and metadata
+    uint256 nonce;
+    typedef boost::unordered_set<uint256, CSigmaProofCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_proofcache;
+
+public:
+    CSigmaProofCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    // Anonymity set is identified by the last block contributing to it, blocks before it are
+    // fixed by its hash. Spend serialization covers the proof, serial, denomination and signature.
+    void
+    ComputeEntry(uint256& entry, const CoinSpend& spend, CoinDenomination denomination, int coinGroupId,
+            const uint256& setTip, size_t setSize, const uint256& metadataHash)
+    {
+        CHashWriter ss(SER_GETHASH, 0);
+        ss << nonce << spend << (int)denomination << coinGroupId << setTip << (uint64_t)setSize << metadataHash;
+        entry = ss.GetHash();
+    }
+
+    bool
+    Get(const uint256& entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_proofcache);
+        return setValid.count(entry);
+    }
+
+    void Set(const uint256& entry)
+    {
+        size_t nMaxCacheSize = GetArg("-maxsigmaproofcachesize", DEFAULT_MAX_SIGMA_PROOF_CACHE_SIZE) * ((size_t) 1 << 20);
+        if (nMaxCacheSize <= 0) return;
+
+        boost::unique_lock<boost::shared_mutex> lock(cs_proofcache);
+        while (memusage::DynamicUsage(setValid) > nMaxCacheSize)
+        {
+            map_type::size_type s = GetRand(setValid.bucket_count());
+            map_type::local_iterator it = setValid.begin(s);
+            if (it != setValid.end(s)) {
+                setValid.erase(*it);
+            }
+        }
+
+        setValid.insert(entry);
+    }
+};
+
+CSigmaProofCache sigmaProofCache;
+
+}
+
 static bool CheckSigmaSpendSerial(
         CValidationState &state,
         CSigmaTxInfo *sigmaTxInfo,
@@ -232,7 +315,6 @@ bool CheckSigmaSpendTransaction(
                     "CheckSigmaSpendTransaction: Error: no coins were minted with such parameters");
 
         bool passVerify = false;
-        CBlockIndex *index = coinGroup.lastBlock;
         pair<sigma::CoinDenomination, int> denominationAndId = std::make_pair(
             targetDenominations[vinIndex], coinGroupId);
 
@@ -244,25 +326,39 @@ bool CheckSigmaSpendTransaction(
             accumulatorBlockHash,
             txHashForMetadata);
 
-        // find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
-        while (index != coinGroup.firstBlock && index->GetBlockHash() != accumulatorBlockHash)
-            index = index->pprev;
-
-        // Build a vector with all the public coins with given denomination and accumulator id before
+        // Anonymity set with all the public coins with given denomination and accumulator id before
         // the block on which the spend occured.
-        // This list of public coins is required by function "Verify" of CoinSpend.
-        std::vector<sigma::PublicCoin> anonymity_set;
-        while(true) {
-            BOOST_FOREACH(const sigma::PublicCoin& pubCoinValue,
-                    index->sigmaMintedPubCoins[denominationAndId]) {
-                anonymity_set.push_back(pubCoinValue);
-            }
-            if (index == coinGroup.firstBlock)
-                break;
-            index = index->pprev;
+        const GroupElement* anonymity_set;
+        size_t setSize;
+        uint256 setTip;
+        if (!sigmaState.GetAnonymitySet(
+                denominationAndId.first, denominationAndId.second, accumulatorBlockHash, anonymity_set, setSize, &setTip)) {
+            LogPrintf("CheckSigmaSpendTransaction: no anonymity set at block %d\n", nHeight);
+            return state.DoS(100, false, REJECT_INVALID, "CheckSigmaSpendTransaction: anonymity set not found");
+        }
+
+        uint256 proofCacheEntry;
+        sigmaProofCache.ComputeEntry(proofCacheEntry, *spend, denominationAndId.first, denominationAndId.second,
+                setTip, setSize, txHashForMetadata);
+        bool fProofPending = false;
+
+        if (sigmaProofCache.Get(proofCacheEntry)) {
+            // exactly the same spend was already verified against the same set
+            passVerify = true;
+        }
+        else if (sigmaTxInfo && sigmaTxInfo->fBatchVerify) {
+            // the proof is verified later by CheckSigmaSpendBatch
+            passVerify = spend->HasValidSignature(newMetaData);
+            fProofPending = true;
+        }
+        else {
+            passVerify = spend->HasValidSignature(newMetaData)
+                && sigma::CoinSpend::BatchVerify(
+                    sigma::Params::get_default(), anonymity_set, setSize, {setSize}, {spend.get()});
+            if (passVerify)
+                sigmaProofCache.Set(proofCacheEntry);
         }
 
-        passVerify = spend->Verify(anonymity_set, newMetaData);
         if (passVerify) {
             Scalar serial = spend->getCoinSerialNumber();
             // do not check for duplicates in case we've seen exact copy of this tx in this block before
@@ -287,6 +383,11 @@ bool CheckSigmaSpendTransaction(
                                 serial, CSpendCoinInfo::make(spend->getDenomination(), coinGroupId)));
                 }
             }
+
+            if (fProofPending) {
+                sigmaTxInfo->pendingSpends.emplace_back(
+                    std::move(spend), targetDenominations[vinIndex], coinGroupId, hashTx, proofCacheEntry);
+            }
         }
         else {
             LogPrintf("CheckSigmaSpendTransaction: verification failed at block %d\n", nHeight);
@@ -473,6 +574,102 @@ bool CheckSigmaTransaction(
     return true;
 }
 
+bool CSigmaSpendCheck::operator()() {
+    return sigma::CoinSpend::BatchVerify(sigma::Params::get_default(), anonymitySet, setSize, setSizes, spends);
+}
+
+bool CheckSigmaSpendBatch(CValidationState &state, CSigmaTxInfo *sigmaTxInfo) {
+    if (!sigmaTxInfo || sigmaTxInfo->pendingSpends.empty())
+        return true;
+
+    std::map<std::pair<sigma::CoinDenomination, int>, std::vector<const CSigmaPendingSpend*>> groupSpends;
+    for (const CSigmaPendingSpend& pending : sigmaTxInfo->pendingSpends) {
+        groupSpends[std::make_pair(pending.denomination, pending.coinGroupId)].push_back(&pending);
+    }
+
+    const sigma::Params* params = sigma::Params::get_default();
+
+    // Anonymity sets are resolved here, under cs_main, proofs are checked by the verification threads.
+    // Spends of each group are split into at most one chunk per thread, every chunk is verified in one batch.
+    size_t nChunksPerGroup = std::max(nScriptCheckThreads, 1);
+    std::vector<CVerificationCheck> vChecks;
+    std::vector<std::pair<const GroupElement*, size_t>> groupSets;
+    std::vector<std::vector<size_t>> groupSetSizes;
+
+    for (const auto& group : groupSpends) {
+        CSigmaState::SigmaCoinGroupInfo coinGroup;
+        if (!sigmaState.GetCoinGroupInfo(group.first.first, group.first.second, coinGroup))
+            return state.DoS(100, false, NO_MINT_ZEROCOIN,
+                    "CheckSigmaSpendBatch: Error: no coins were minted with such parameters");
+
+        // Anonymity set of every spend is a tail of the whole group
+        const GroupElement* anonymity_set;
+        size_t setSize;
+        sigmaState.GetAnonymitySet(group.first.first, group.first.second,
+                coinGroup.lastBlock->GetBlockHash(), anonymity_set, setSize);
+
+        std::vector<size_t> setSizes;
+        for (const CSigmaPendingSpend* pending : group.second) {
+            const GroupElement* spendSet;
+            size_t spendSetSize;
+            sigmaState.GetAnonymitySet(group.first.first, group.first.second,
+                    pending->spend->getAccumulatorBlockHash(), spendSet, spendSetSize);
+            setSizes.push_back(spendSetSize);
+        }
+
+        size_t nSpends = group.second.size();
+        size_t nChunks = std::min(nSpends, nChunksPerGroup);
+        for (size_t chunk = 0; chunk < nChunks; chunk++) {
+            size_t begin = nSpends * chunk / nChunks, end = nSpends * (chunk + 1) / nChunks;
+            std::vector<const sigma::CoinSpend*> spends;
+            for (size_t i = begin; i < end; i++)
+                spends.push_back(group.second[i]->spend.get());
+            auto check = std::make_shared<CSigmaSpendCheck>(anonymity_set, setSize,
+                    std::vector<size_t>(setSizes.begin() + begin, setSizes.begin() + end), std::move(spends));
+            vChecks.emplace_back([check]() { return (*check)(); });
+        }
+
+        groupSets.emplace_back(anonymity_set, setSize);
+        groupSetSizes.push_back(std::move(setSizes));
+    }
+
+    bool fValid;
+    if (nScriptCheckThreads) {
+        CCheckQueueControl<CVerificationCheck> control(&GetVerificationQueue());
+        control.Add(vChecks);
+        fValid = control.Wait();
+    }
+    else {
+        fValid = std::all_of(vChecks.begin(), vChecks.end(), [](CVerificationCheck& check) { return check(); });
+    }
+
+    if (!fValid) {
+        // Some proof is invalid, verify them one by one to find out which one.
+        size_t groupIndex = 0;
+        for (const auto& group : groupSpends) {
+            const GroupElement* anonymity_set = groupSets[groupIndex].first;
+            size_t setSize = groupSets[groupIndex].second;
+            const std::vector<size_t>& setSizes = groupSetSizes[groupIndex++];
+            for (size_t i = 0; i < group.second.size(); i++) {
+                if (!sigma::CoinSpend::BatchVerify(params, anonymity_set, setSize, {setSizes[i]}, {group.second[i]->spend.get()})) {
+                    LogPrintf("CheckSigmaSpendBatch: verification failed, tx=%s\n", group.second[i]->txHash.ToString());
+                    return state.DoS(100, false, REJECT_INVALID, "bad-txns-spend-invalid", false,
+                        strprintf("sigma spend verification failed (tx hash %s)", group.second[i]->txHash.ToString()));
+                }
+            }
+        }
+
+        return state.DoS(100, false, REJECT_INVALID, "bad-txns-spend-invalid", false,
+            "sigma spend batch verification failed");
+    }
+
+    for (const CSigmaPendingSpend& pending : sigmaTxInfo->pendingSpends)
+        sigmaProofCache.Set(pending.cacheEntry);
+
+    sigmaTxInfo->pendingSpends.clear();
+    return true;
+}
+
 void RemoveSigmaSpendsReferencingBlock(CTxMemPool& pool, CBlockIndex* blockIndex) {
     LOCK2(cs_main, pool.cs);
     std::vector<CTransaction> txn_to_remove;
@@ -569,10 +766,7 @@ bool ConnectBlockSigma(
         bool fJustCheck) {
     // Add zerocoin transaction information to index
     if (pblock && pblock->sigmaTxInfo) {
-        if (!fJustCheck) {
-            pindexNew->sigmaMintedPubCoins.clear();
-            pindexNew->sigmaSpentSerials.clear();
-        }
+        CSigmaBlockData blockData;
 
         if (!sigma::CheckSigmaBlock(state, *pblock)) {
             return false;
@@ -590,7 +784,7 @@ bool ConnectBlockSigma(
             }
 
             if (!fJustCheck) {
-                pindexNew->sigmaSpentSerials.insert(serial);
+                blockData.spends.insert(serial);
                 sigmaState.AddSpend(serial.first, serial.second.denomination, serial.second.coinGroupId);
             }
         }
@@ -598,7 +792,10 @@ bool ConnectBlockSigma(
         if (fJustCheck)
             return true;
 
-        sigmaState.AddMintsToStateAndBlockIndex(pindexNew, pblock);
+        sigmaState.AddMintsToStateAndBlockIndex(pindexNew, pblock, blockData);
+
+        if (!blockData.IsEmpty())
+            mapPendingSigmaBlockData[pindexNew] = std::move(blockData);
     }
     else if (!fJustCheck) { // TODO(martun): not sure if this else is necessary here. Check again later.
         sigmaState.AddBlock(pindexNew);
@@ -688,12 +885,142 @@ bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash) {
     return GetOutPoint(outPoint, pubCoinValue);
 }
 
+static boost::filesystem::path GetSigmaStateSnapshotPath() {
+    return GetDataDir() / "sigmastate.dat";
+}
+
+// block the snapshot on disk was taken at
+static uint256 hashSigmaStateSnapshot;
+
+// Load sigma state from the snapshot, returns the block it was taken at or NULL if there is no usable snapshot
+static const CBlockIndex *ReadSigmaStateSnapshot(CChain *chain) {
+    boost::filesystem::path pathSnapshot = GetSigmaStateSnapshotPath();
+    if (!boost::filesystem::exists(pathSnapshot))
+        return NULL;
+
+    FILE *file = fopen(pathSnapshot.string().c_str(), "rb");
+    CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        error("%s: Failed to open file %s", __func__, pathSnapshot.string());
+        return NULL;
+    }
+
+    uint64_t fileSize = boost::filesystem::file_size(pathSnapshot);
+    uint64_t dataSize = fileSize >= sizeof(uint256) ? fileSize - sizeof(uint256) : 0;
+    std::vector<unsigned char> vchData(dataSize);
+    uint256 hashIn;
+    try {
+        filein.read((char *) vchData.data(), dataSize);
+        filein >> hashIn;
+    }
+    catch (const std::exception &e) {
+        error("%s: Deserialize or I/O error - %s", __func__, e.what());
+        return NULL;
+    }
+    filein.fclose();
+
+    CDataStream ssSnapshot(vchData, SER_DISK, CLIENT_VERSION);
+    if (hashIn != Hash(ssSnapshot.begin(), ssSnapshot.end())) {
+        error("%s: Checksum mismatch, data corrupted", __func__);
+        return NULL;
+    }
+
+    try {
+        unsigned char pchMsgTmp[4];
+        int nVersion;
+        uint256 tipHash;
+        ssSnapshot >> FLATDATA(pchMsgTmp) >> nVersion >> tipHash;
+
+        if (memcmp(pchMsgTmp, ::Params().MessageStart(), sizeof(pchMsgTmp)) != 0) {
+            error("%s: Invalid network magic number", __func__);
+            return NULL;
+        }
+        if (nVersion != SIGMA_STATE_SNAPSHOT_VERSION) {
+            LogPrintf("%s: snapshot version %d is not supported, ignoring it\n", __func__, nVersion);
+            return NULL;
+        }
+
+        BlockMap::const_iterator mi = mapBlockIndex.find(tipHash);
+        if (mi == mapBlockIndex.end() || !chain->Contains(mi->second)) {
+            LogPrintf("%s: snapshot block %s is not in the active chain, ignoring it\n", __func__, tipHash.ToString());
+            return NULL;
+        }
+
+        sigmaState.ReadSnapshot(ssSnapshot, mi->second);
+        hashSigmaStateSnapshot = tipHash;
+        return mi->second;
+    }
+    catch (const std::exception &e) {
+        sigmaState.Reset();
+        error("%s: Deserialize error - %s", __func__, e.what());
+        return NULL;
+    }
+}
+
+bool WriteSigmaStateSnapshot(const uint256 &tipHash) {
+    if (tipHash == hashSigmaStateSnapshot)
+        return true;
+
+    int64_t nStart = GetTimeMillis();
+
+    // Generate random temporary filename
+    unsigned short randv = 0;
+    GetRandBytes((unsigned char *) &randv, sizeof(randv));
+    std::string tmpfn = strprintf("sigmastate.dat.%04x", randv);
+
+    // serialize the state, checksum data up to that point, then append csum
+    CDataStream ssSnapshot(SER_DISK, CLIENT_VERSION);
+    ssSnapshot << FLATDATA(::Params().MessageStart()) << SIGMA_STATE_SNAPSHOT_VERSION << tipHash;
+    sigmaState.WriteSnapshot(ssSnapshot);
+    uint256 hash = Hash(ssSnapshot.begin(), ssSnapshot.end());
+    ssSnapshot << hash;
+
+    boost::filesystem::path pathTmp = GetDataDir() / tmpfn;
+    FILE *file = fopen(pathTmp.string().c_str(), "wb");
+    CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
+    if (fileout.IsNull())
+        return error("%s: Failed to open file %s", __func__, pathTmp.string());
+
+    try {
+        fileout << ssSnapshot;
+    }
+    catch (const std::exception &e) {
+        return error("%s: Serialize or I/O error - %s", __func__, e.what());
+    }
+    FileCommit(fileout.Get());
+    fileout.fclose();
+
+    if (!RenameOver(pathTmp, GetSigmaStateSnapshotPath()))
+        return error("%s: Rename-into-place failed", __func__);
+
+    hashSigmaStateSnapshot = tipHash;
+    LogPrint("bench", "Wrote sigma state snapshot at block %s: %d bytes, %dms\n",
+        tipHash.ToString(), ssSnapshot.size(), GetTimeMillis() - nStart);
+    return true;
+}
+
 bool BuildSigmaStateFromIndex(CChain *chain) {
+    int64_t nStart = GetTimeMillis();
+
     sigmaState.Reset();
-    for (CBlockIndex *blockIndex = chain->Genesis(); blockIndex; blockIndex=chain->Next(blockIndex))
-    {
-        sigmaState.AddBlock(blockIndex);
-    }
+    hashSigmaStateSnapshot.SetNull();
+
+    // Only blocks above the snapshot are replayed
+    int nStartHeight = 0;
+    if (const CBlockIndex *snapshotTip = ReadSigmaStateSnapshot(chain))
+        nStartHeight = snapshotTip->nHeight + 1;
+
+    // Records come in height order, those of blocks off the chain are skipped
+    bool fLoaded = pblocktree->LoadSigmaBlockData(nStartHeight,
+        [chain](int nHeight, const uint256 &blockHash, const CSigmaBlockData &blockData) {
+            CBlockIndex *blockIndex = (*chain)[nHeight];
+            if (blockIndex && blockIndex->GetBlockHash() == blockHash)
+                sigmaState.AddBlock(blockIndex, blockData);
+        });
+    if (!fLoaded)
+        return false;
+
+    LogPrintf("Sigma state built from height %d in %dms\n", nStartHeight, GetTimeMillis() - nStart);
     // DEBUG
     LogPrintf(
         "Latest IDs for sigma coin groups are %d, %d, %d, %d, %d, %d, %d, %d\n",
@@ -708,6 +1035,27 @@ bool BuildSigmaStateFromIndex(CChain *chain) {
     return true;
 }
 
+bool GetSigmaBlockData(const CBlockIndex *pindex, CSigmaBlockData &data) {
+    auto it = mapPendingSigmaBlockData.find(pindex);
+    if (it != mapPendingSigmaBlockData.end()) {
+        data = it->second;
+        return true;
+    }
+    return pblocktree->ReadSigmaBlockData(pindex, data);
+}
+
+std::vector<std::pair<const CBlockIndex*, const CSigmaBlockData*>> GetPendingSigmaBlockData() {
+    std::vector<std::pair<const CBlockIndex*, const CSigmaBlockData*>> result;
+    result.reserve(mapPendingSigmaBlockData.size());
+    for (const auto& entry : mapPendingSigmaBlockData)
+        result.emplace_back(entry.first, &entry.second);
+    return result;
+}
+
+void ClearPendingSigmaBlockData() {
+    mapPendingSigmaBlockData.clear();
+}
+
 // CsigmaTxinfo
 
 void CSigmaTxInfo::Complete() {
@@ -803,6 +1151,55 @@ void CSigmaState::Containers::CheckSurgeCondition(int groupId, CoinDenomination
     surgeCondition = result;
 }
 
+/******************************************************************************/
+// CSigmaState::SigmaCoinGroupSet
+/******************************************************************************/
+
+void CSigmaState::SigmaCoinGroupSet::AddBlock(int nHeight, const std::vector<sigma::PublicCoin>& coins) {
+    if (coins.empty())
+        return;
+
+    assert(blocks.empty() || blocks.back().first < nHeight);
+
+    size_t nNewCoins = nCoins + coins.size();
+    if (nNewCoins > buffer.size()) {
+        // grow to the left keeping the coins at the end
+        std::vector<GroupElement> newBuffer(std::max(nNewCoins, buffer.size() * 2));
+        std::copy(buffer.end() - nCoins, buffer.end(), newBuffer.end() - nCoins);
+        buffer.swap(newBuffer);
+    }
+
+    std::transform(coins.begin(), coins.end(), buffer.end() - nNewCoins,
+        [](const sigma::PublicCoin& coin) { return coin.getValue(); });
+
+    nCoins = nNewCoins;
+    blocks.emplace_back(nHeight, nCoins);
+}
+
+void CSigmaState::SigmaCoinGroupSet::RemoveBlock(int nHeight) {
+    assert(!blocks.empty() && blocks.back().first == nHeight);
+
+    blocks.pop_back();
+    nCoins = blocks.empty() ? 0 : blocks.back().second;
+}
+
+size_t CSigmaState::SigmaCoinGroupSet::GetSetSize(int nHeight) const {
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), nHeight,
+        [](int height, const std::pair<int, size_t>& block) { return height < block.first; });
+    return it == blocks.begin() ? 0 : std::prev(it)->second;
+}
+
+int CSigmaState::SigmaCoinGroupSet::GetLastBlockHeight(int nHeight) const {
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), nHeight,
+        [](int height, const std::pair<int, size_t>& block) { return height < block.first; });
+    return it == blocks.begin() ? -1 : std::prev(it)->first;
+}
+
+const GroupElement* CSigmaState::SigmaCoinGroupSet::GetSetBegin(size_t setSize) const {
+    assert(setSize <= nCoins);
+    return buffer.data() + buffer.size() - setSize;
+}
+
 /******************************************************************************/
 // CSigmaState
 /******************************************************************************/
@@ -813,7 +1210,8 @@ CSigmaState::CSigmaState()
 
 void CSigmaState::AddMintsToStateAndBlockIndex(
         CBlockIndex *index,
-        const CBlock* pblock) {
+        const CBlock* pblock,
+        CSigmaBlockData &blockData) {
 
     std::unordered_map<sigma::CoinDenomination, std::vector<sigma::PublicCoin>> blockDenomMints;
     for (const auto& mint : pblock->sigmaTxInfo->mints) {
@@ -858,8 +1256,11 @@ void CSigmaState::AddMintsToStateAndBlockIndex(
             containers.AddMint(mint, CMintedCoinInfo::make(denomination, mintCoinGroupId, index->nHeight));
 
             LogPrintf("AddMintsToStateAndBlockIndex: mint added denomination=%d, id=%d\n", denomination, mintCoinGroupId);
-            index->sigmaMintedPubCoins[{denomination, mintCoinGroupId}].push_back(mint);
         }
+
+        std::vector<sigma::PublicCoin>& groupMints = blockData.mints[{denomination, mintCoinGroupId}];
+        groupMints.insert(groupMints.end(), mintsWithThisDenom.begin(), mintsWithThisDenom.end());
+        coinGroupSets[{denomination, mintCoinGroupId}].AddBlock(index->nHeight, groupMints);
     }
 }
 
@@ -868,9 +1269,15 @@ void CSigmaState::AddSpend(const Scalar &serial, CoinDenomination denom, int coi
 }
 
 void CSigmaState::AddBlock(CBlockIndex *index) {
+    CSigmaBlockData blockData;
+    if (GetSigmaBlockData(index, blockData))
+        AddBlock(index, blockData);
+}
+
+void CSigmaState::AddBlock(CBlockIndex *index, const CSigmaBlockData &blockData) {
     BOOST_FOREACH(
         const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int), vector<sigma::PublicCoin>) &pubCoins,
-            index->sigmaMintedPubCoins) {
+            blockData.mints) {
         if (!pubCoins.second.empty()) {
             SigmaCoinGroupInfo& coinGroup = coinGroups[pubCoins.first];
 
@@ -878,6 +1285,8 @@ void CSigmaState::AddBlock(CBlockIndex *index) {
                 coinGroup.firstBlock = index;
             coinGroup.lastBlock = index;
             coinGroup.nCoins += pubCoins.second.size();
+
+            coinGroupSets[pubCoins.first].AddBlock(index->nHeight, pubCoins.second);
         }
 
         latestCoinIds[pubCoins.first.first] = pubCoins.first.second;
@@ -886,25 +1295,34 @@ void CSigmaState::AddBlock(CBlockIndex *index) {
         }
     }
 
-    BOOST_FOREACH(const spend_info_container::value_type &serial, index->sigmaSpentSerials) {
+    BOOST_FOREACH(const spend_info_container::value_type &serial, blockData.spends) {
         AddSpend(serial.first, serial.second.denomination, serial.second.coinGroupId);
     }
 }
 
 void CSigmaState::RemoveBlock(CBlockIndex *index) {
+    CSigmaBlockData blockData;
+    if (!GetSigmaBlockData(index, blockData))
+        return;
+
     // roll back accumulator updates
     BOOST_FOREACH(
         const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int),vector<sigma::PublicCoin>) &coin,
-        index->sigmaMintedPubCoins)
+        blockData.mints)
     {
         SigmaCoinGroupInfo   &coinGroup = coinGroups[coin.first];
         int  nMintsToForget = coin.second.size();
 
         assert(coinGroup.nCoins >= nMintsToForget);
 
+        SigmaCoinGroupSet &coinGroupSet = coinGroupSets[coin.first];
+        if (nMintsToForget > 0)
+            coinGroupSet.RemoveBlock(index->nHeight);
+
         if ((coinGroup.nCoins -= nMintsToForget) == 0) {
             // all the coins of this group have been erased, remove the group altogether
             coinGroups.erase(coin.first);
+            coinGroupSets.erase(coin.first);
             // decrease pubcoin id for this denomination
             latestCoinIds[coin.first.first]--;
             if (0 == latestCoinIds[coin.first.first]) {
@@ -912,19 +1330,19 @@ void CSigmaState::RemoveBlock(CBlockIndex *index) {
             }
         }
         else {
-            // roll back lastBlock to previous position
+            // roll back lastBlock to the previous block having coins of the group
             assert(coinGroup.lastBlock == index);
+            assert(coinGroup.lastBlock != coinGroup.firstBlock);
 
-            do {
-                assert(coinGroup.lastBlock != coinGroup.firstBlock);
-                coinGroup.lastBlock = coinGroup.lastBlock->pprev;
-            } while (coinGroup.lastBlock->sigmaMintedPubCoins.count(coin.first) == 0);
+            coinGroup.lastBlock = coinGroup.lastBlock->GetAncestor(
+                coinGroupSet.GetLastBlockHeight(std::numeric_limits<int>::max()));
+            assert(coinGroup.lastBlock != NULL);
         }
     }
 
     // roll back mints
     BOOST_FOREACH(const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int),vector<sigma::PublicCoin>) &pubCoins,
-                  index->sigmaMintedPubCoins) {
+                  blockData.mints) {
         BOOST_FOREACH(const sigma::PublicCoin &coin, pubCoins.second) {
             auto coins = containers.GetMints().equal_range(coin);
             auto coinIt = find_if(
@@ -939,7 +1357,7 @@ void CSigmaState::RemoveBlock(CBlockIndex *index) {
     }
 
     // roll back spends
-    BOOST_FOREACH(const spend_info_container::value_type &serial, index->sigmaSpentSerials) {
+    BOOST_FOREACH(const spend_info_container::value_type &serial, blockData.spends) {
         containers.RemoveSpend(serial.first);
     }
 }
@@ -998,33 +1416,58 @@ int CSigmaState::GetCoinSetForSpend(
 
     pair<sigma::CoinDenomination, int> denomAndId = std::make_pair(denomination, coinGroupID);
 
-    if (coinGroups.count(denomAndId) == 0)
+    auto coinGroup = coinGroups.find(denomAndId);
+    auto coinGroupSet = coinGroupSets.find(denomAndId);
+    if (coinGroup == coinGroups.end() || coinGroupSet == coinGroupSets.end())
         return 0;
 
-    SigmaCoinGroupInfo coinGroup = coinGroups[denomAndId];
-
-    int numberOfCoins = 0;
-    for (CBlockIndex *block = coinGroup.lastBlock;
-            ;
-            block = block->pprev) {
-        if (block->sigmaMintedPubCoins[denomAndId].size() > 0) {
-            if (block->nHeight <= maxHeight) {
-                if (numberOfCoins == 0) {
-                    // latest block satisfying given conditions
-                    // remember block hash
-                    blockHash_out = block->GetBlockHash();
-                }
-                numberOfCoins += block->sigmaMintedPubCoins[denomAndId].size();
-                coins_out.insert(coins_out.end(),
-                        block->sigmaMintedPubCoins[denomAndId].begin(),
-                        block->sigmaMintedPubCoins[denomAndId].end());
-            }
-        }
-        if (block == coinGroup.firstBlock) {
-            break ;
-        }
+    // latest block satisfying given conditions
+    int nSetTipHeight = coinGroupSet->second.GetLastBlockHeight(maxHeight);
+    if (nSetTipHeight < 0)
+        return 0;
+    blockHash_out = coinGroup->second.lastBlock->GetAncestor(nSetTipHeight)->GetBlockHash();
+
+    size_t setSize = coinGroupSet->second.GetSetSize(nSetTipHeight);
+    const GroupElement *set = coinGroupSet->second.GetSetBegin(setSize);
+    coins_out.reserve(setSize);
+    for (size_t i = 0; i < setSize; i++)
+        coins_out.emplace_back(set[i], denomination);
+
+    return setSize;
+}
+
+bool CSigmaState::GetAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int coinGroupID,
+        const uint256& accumulatorBlockHash,
+        const GroupElement*& set_out,
+        size_t& setSize_out,
+        uint256* setTip_out) {
+    pair<sigma::CoinDenomination, int> denomAndId = std::make_pair(denomination, coinGroupID);
+
+    auto coinGroup = coinGroups.find(denomAndId);
+    auto coinGroupSet = coinGroupSets.find(denomAndId);
+    if (coinGroup == coinGroups.end() || coinGroupSet == coinGroupSets.end())
+        return false;
+
+    // The set ends at the accumulator block if it lies within the group, otherwise it consists
+    // of the coins of the first block only
+    const CBlockIndex *firstBlock = coinGroup->second.firstBlock;
+    const CBlockIndex *lastBlock = coinGroup->second.lastBlock;
+    const CBlockIndex *setTip = firstBlock;
+
+    BlockMap::const_iterator mi = mapBlockIndex.find(accumulatorBlockHash);
+    if (mi != mapBlockIndex.end()
+            && mi->second->nHeight >= firstBlock->nHeight
+            && lastBlock->GetAncestor(mi->second->nHeight) == mi->second) {
+        setTip = mi->second;
     }
-    return numberOfCoins;
+
+    if (setTip_out)
+        *setTip_out = setTip->GetBlockHash();
+    setSize_out = coinGroupSet->second.GetSetSize(setTip->nHeight);
+    set_out = coinGroupSet->second.GetSetBegin(setSize_out);
+    return true;
 }
 
 std::pair<int, int> CSigmaState::GetMintedCoinHeightAndId(
@@ -1085,8 +1528,98 @@ bool CSigmaState::CanAddMintToMempool(const GroupElement& pubCoin){
     return mempoolMints.count(pubCoin) == 0;
 }
 
+void CSigmaState::WriteSnapshot(CDataStream &s) const {
+    // groups are written in the order of their keys, so are the mints of a block when it's added
+    std::map<std::pair<CoinDenomination, int>, const SigmaCoinGroupSet*> groups;
+    for (const auto& group : coinGroupSets)
+        groups[group.first] = &group.second;
+
+    WriteCompactSize(s, groups.size());
+    for (const auto& group : groups) {
+        sigma::Serialize(s, group.first.first, s.GetType(), s.GetVersion());
+        WriteCompactSize(s, group.first.second);
+        s << *group.second;
+    }
+
+    WriteCompactSize(s, latestCoinIds.size());
+    for (const auto& latestCoinId : latestCoinIds) {
+        sigma::Serialize(s, latestCoinId.first, s.GetType(), s.GetVersion());
+        WriteCompactSize(s, latestCoinId.second);
+    }
+
+    const spend_info_container& spends = containers.GetSpends();
+    WriteCompactSize(s, spends.size());
+    for (const auto& spend : spends) {
+        s << spend.first;
+        sigma::Serialize(s, spend.second.denomination, s.GetType(), s.GetVersion());
+        WriteCompactSize(s, spend.second.coinGroupId);
+    }
+}
+
+void CSigmaState::ReadSnapshot(CDataStream &s, const CBlockIndex *tip) {
+    Reset();
+
+    // mints of every block of every group, to be added in the same order AddBlock does
+    struct BlockMints {
+        int nHeight;
+        std::pair<CoinDenomination, int> group;
+        const GroupElement *begin;
+        size_t nCoins;
+    };
+    std::vector<BlockMints> blockMints;
+
+    for (uint64_t nGroups = ReadCompactSize(s); nGroups > 0; nGroups--) {
+        CoinDenomination denomination;
+        sigma::Unserialize(s, denomination, s.GetType(), s.GetVersion());
+        std::pair<CoinDenomination, int> key(denomination, ReadCompactSize(s));
+
+        SigmaCoinGroupSet& coinGroupSet = coinGroupSets[key];
+        s >> coinGroupSet;
+
+        const std::vector<std::pair<int, size_t>>& blocks = coinGroupSet.GetBlocks();
+        if (blocks.empty() || blocks.back().first > tip->nHeight)
+            throw std::ios_base::failure("invalid coin group");
+
+        SigmaCoinGroupInfo& coinGroup = coinGroups[key];
+        coinGroup.firstBlock = const_cast<CBlockIndex*>(tip->GetAncestor(blocks.front().first));
+        coinGroup.lastBlock = const_cast<CBlockIndex*>(tip->GetAncestor(blocks.back().first));
+        coinGroup.nCoins = blocks.back().second;
+
+        size_t nPrevCoins = 0;
+        for (const auto& block : blocks) {
+            blockMints.push_back({block.first, key, coinGroupSet.GetSetBegin(block.second), block.second - nPrevCoins});
+            nPrevCoins = block.second;
+        }
+    }
+
+    for (uint64_t nIds = ReadCompactSize(s); nIds > 0; nIds--) {
+        CoinDenomination denomination;
+        sigma::Unserialize(s, denomination, s.GetType(), s.GetVersion());
+        latestCoinIds[denomination] = ReadCompactSize(s);
+    }
+
+    std::sort(blockMints.begin(), blockMints.end(), [](const BlockMints& a, const BlockMints& b) {
+        return a.nHeight < b.nHeight || (a.nHeight == b.nHeight && a.group < b.group);
+    });
+    for (const BlockMints& mints : blockMints) {
+        CMintedCoinInfo coinInfo = CMintedCoinInfo::make(mints.group.first, mints.group.second, mints.nHeight);
+        for (const GroupElement *coin = mints.begin; coin != mints.begin + mints.nCoins; ++coin)
+            containers.AddMint(sigma::PublicCoin(*coin, mints.group.first), coinInfo);
+    }
+
+    // spends go after the mints so the surge condition isn't reported in between
+    for (uint64_t nSpends = ReadCompactSize(s); nSpends > 0; nSpends--) {
+        Scalar serial;
+        CoinDenomination denomination;
+        s >> serial;
+        sigma::Unserialize(s, denomination, s.GetType(), s.GetVersion());
+        AddSpend(serial, denomination, ReadCompactSize(s));
+    }
+}
+
 void CSigmaState::Reset() {
     coinGroups.clear();
+    coinGroupSets.clear();
     latestCoinIds.clear();
     mempoolCoinSerials.clear();
     mempoolMints.clear();
@@ -1126,7 +1659,7 @@ std::unordered_map<CoinDenomination, int> const & CSigmaState::GetLatestCoinIds(
     return latestCoinIds;
 }
 
-std::unordered_map<Scalar, uint256, CScalarHash> const & CSigmaState::GetMempoolCoinSerials() const {
+flathashmap<Scalar, uint256, CScalarHash> const & CSigmaState::GetMempoolCoinSerials() const {
     return mempoolCoinSerials;
 }
 
@@ -6,6 +6,7 @@
 #include "sigma/coin.h"
 #include "sigma/coinspend.h"
 #include "consensus/validation.h"
+#include "streams.h"
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
 #include "sigma/params.h"
@@ -22,6 +23,25 @@ namespace zerocoin_tests3_v3 { struct zerocoin_mintspend_v3; }
 
 namespace sigma {
 
+// DoS prevention: limit cache of verified sigma proofs to 10MB
+static const unsigned int DEFAULT_MAX_SIGMA_PROOF_CACHE_SIZE = 10;
+
+// Format version of the sigma state snapshot, snapshots of other versions are ignored
+static const int SIGMA_STATE_SNAPSHOT_VERSION = 1;
+
+// Sigma spend whose proof verification is deferred until all the transactions of the block are checked
+struct CSigmaPendingSpend {
+    CSigmaPendingSpend(std::unique_ptr<sigma::CoinSpend> spend, sigma::CoinDenomination denomination, int coinGroupId, uint256 txHash, uint256 cacheEntry)
+        : spend(std::move(spend)), denomination(denomination), coinGroupId(coinGroupId), txHash(txHash), cacheEntry(cacheEntry) {}
+
+    std::shared_ptr<sigma::CoinSpend> spend;
+    sigma::CoinDenomination denomination;
+    int coinGroupId;
+    uint256 txHash;
+    // entry of the verified proof cache to be set once the proof is verified
+    uint256 cacheEntry;
+};
+
 // Zerocoin transaction info, added to the CBlock to ensure zerocoin mint/spend transactions got their info stored into
 // index
 class CSigmaTxInfo {
@@ -38,7 +58,12 @@ public:
     // information about transactions in the block is complete
     bool fInfoIsComplete;
 
-    CSigmaTxInfo(): fInfoIsComplete(false) {}
+    // if set, sigma proofs are not verified by CheckSigmaTransaction but collected in pendingSpends
+    // to be verified in a batch by CheckSigmaSpendBatch
+    bool fBatchVerify;
+    std::vector<CSigmaPendingSpend> pendingSpends;
+
+    CSigmaTxInfo(): fInfoIsComplete(false), fBatchVerify(false) {}
 
     // finalize everything
     void Complete();
@@ -61,6 +86,31 @@ bool CheckSigmaTransaction(
     bool isCheckWallet,
     CSigmaTxInfo *sigmaTxInfo);
 
+/**
+ * Closure representing batch verification of sigma proofs sharing one anonymity set.
+ * Stores pointers to the anonymity set and the spends, both must outlive the check.
+ */
+class CSigmaSpendCheck
+{
+private:
+    const GroupElement *anonymitySet;
+    size_t setSize;
+    std::vector<size_t> setSizes;
+    std::vector<const sigma::CoinSpend*> spends;
+
+public:
+    CSigmaSpendCheck(const GroupElement *anonymitySetIn, size_t setSizeIn,
+            std::vector<size_t> setSizesIn, std::vector<const sigma::CoinSpend*> spendsIn) :
+        anonymitySet(anonymitySetIn), setSize(setSizeIn), setSizes(std::move(setSizesIn)), spends(std::move(spendsIn)) {}
+
+    bool operator()();
+};
+
+// Verify proofs of all the spends collected in sigmaTxInfo, spends sharing an anonymity set
+// are verified together. Proof checks are spread over the -par verification threads, which
+// must not be in use by a script check control at the same time.
+bool CheckSigmaSpendBatch(CValidationState &state, CSigmaTxInfo *sigmaTxInfo);
+
 void DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete);
 
 bool ConnectBlockSigma(
@@ -78,8 +128,22 @@ bool GetOutPoint(COutPoint& outPoint, const sigma::PublicCoin &pubCoin);
 bool GetOutPoint(COutPoint& outPoint, const GroupElement &pubCoinValue);
 bool GetOutPoint(COutPoint& outPoint, const uint256 &pubCoinValueHash);
 
+// Load sigma state from the snapshot if it was taken at a block of the chain and add the blocks above it,
+// replay the whole chain otherwise
 bool BuildSigmaStateFromIndex(CChain *chain);
 
+// Write the snapshot of sigma state tagged with the hash of the block the state corresponds to.
+// Called by FlushStateToDisk once the chainstate is flushed, does nothing if the snapshot is up to date
+bool WriteSigmaStateSnapshot(const uint256 &tipHash);
+
+// Sigma mints and spends of the block, false if it has none
+bool GetSigmaBlockData(const CBlockIndex *pindex, CSigmaBlockData &data);
+
+// Sigma data of connected blocks not yet written to the block tree database. It's written by
+// FlushStateToDisk together with the block index, after that ClearPendingSigmaBlockData is called
+std::vector<std::pair<const CBlockIndex*, const CSigmaBlockData*>> GetPendingSigmaBlockData();
+void ClearPendingSigmaBlockData();
+
 Scalar GetSigmaSpendSerialNumber(const CTransaction &tx, const CTxIn &txin);
 CAmount GetSigmaSpendInput(const CTransaction &tx);
 
@@ -100,6 +164,64 @@ public:
         int nCoins;
     };
 
+    // Public coin values of a coin group in the order anonymity sets are built in: coins of the latest
+    // block go first. New blocks are prepended, so the anonymity set for any accumulator block is a
+    // contiguous tail of the coins and can be handed to the verifier as is.
+    class SigmaCoinGroupSet {
+    public:
+        SigmaCoinGroupSet() : nCoins(0) {}
+
+        void AddBlock(int nHeight, const std::vector<sigma::PublicCoin>& coins);
+        void RemoveBlock(int nHeight);
+
+        // Number of coins minted in blocks not higher than nHeight
+        size_t GetSetSize(int nHeight) const;
+        // Height of the last block not higher than nHeight having coins, -1 if there is none
+        int GetLastBlockHeight(int nHeight) const;
+        // Start of the last setSize coins
+        const GroupElement* GetSetBegin(size_t setSize) const;
+        const std::vector<std::pair<int, size_t>>& GetBlocks() const { return blocks; }
+
+        // Blocks oldest first followed by the compressed coins
+        template<typename Stream>
+        void Serialize(Stream& s, int nType, int nVersion) const {
+            unsigned char coinBuffer[COMPRESSED_PUBLIC_COIN_SIZE];
+            WriteCompactSize(s, blocks.size());
+            for (const auto& block : blocks) {
+                ::Serialize(s, block.first, nType, nVersion);
+                WriteCompactSize(s, block.second);
+            }
+            for (const GroupElement *coin = GetSetBegin(nCoins); coin != buffer.data() + buffer.size(); ++coin) {
+                CompressPublicCoinValue(*coin, coinBuffer);
+                s.write((const char*)coinBuffer, COMPRESSED_PUBLIC_COIN_SIZE);
+            }
+        }
+
+        template<typename Stream>
+        void Unserialize(Stream& s, int nType, int nVersion) {
+            unsigned char coinBuffer[COMPRESSED_PUBLIC_COIN_SIZE];
+            blocks.resize(ReadCompactSize(s));
+            for (auto& block : blocks) {
+                ::Unserialize(s, block.first, nType, nVersion);
+                block.second = ReadCompactSize(s);
+            }
+            nCoins = blocks.empty() ? 0 : blocks.back().second;
+            std::vector<GroupElement>(nCoins).swap(buffer);
+            for (GroupElement& coin : buffer) {
+                s.read((char*)coinBuffer, COMPRESSED_PUBLIC_COIN_SIZE);
+                DecompressPublicCoinValue(coinBuffer, coin);
+            }
+        }
+
+    private:
+        // coins occupy the last nCoins elements of the buffer
+        std::vector<GroupElement> buffer;
+        size_t nCoins;
+        // height of every block having coins of the group and total number of coins up to
+        // and including that block, oldest block first
+        std::vector<std::pair<int, size_t>> blocks;
+    };
+
     struct pairhash {
       public:
         template <typename T, typename U>
@@ -111,14 +233,15 @@ public:
 public:
     CSigmaState();
 
-    // Add mins in block, automatically assigning id to it
-    void AddMintsToStateAndBlockIndex(CBlockIndex *index, const CBlock* pblock);
+    // Add mins in block, automatically assigning id to it. Assigned ids are recorded in blockData
+    void AddMintsToStateAndBlockIndex(CBlockIndex *index, const CBlock* pblock, CSigmaBlockData &blockData);
 
     // Add serial to the list of used ones
     void AddSpend(const Scalar &serial, CoinDenomination denom, int coinGroupId);
 
     // Add everything from the block to the state
     void AddBlock(CBlockIndex *index);
+    void AddBlock(CBlockIndex *index, const CSigmaBlockData &blockData);
 
     // Disconnect block from the chain rolling back mints and spends
     void RemoveBlock(CBlockIndex *index);
@@ -148,12 +271,28 @@ public:
         uint256& blockHash_out,
         std::vector<sigma::PublicCoin>& coins_out);
 
+    // Given denomination and id returns public coin values of the anonymity set used by a spend
+    // referring to the accumulator block, the same set CoinSpend was created with.
+    // If setTip_out is given it receives the hash of the last block contributing to the set
+    bool GetAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int id,
+        const uint256& accumulatorBlockHash,
+        const GroupElement*& set_out,
+        size_t& setSize_out,
+        uint256* setTip_out = NULL);
+
     // Return height of mint transaction and id of minted coin
     std::pair<int, int> GetMintedCoinHeightAndId(const sigma::PublicCoin& pubCoin);
 
     // Reset to initial values
     void Reset();
 
+    // Snapshot of the state of the chain, mempool mints and spends are not included.
+    // Block pointers are stored as heights and restored from ancestors of the tip
+    void WriteSnapshot(CDataStream &s) const;
+    void ReadSnapshot(CDataStream &s, const CBlockIndex *tip);
+
     // Check if there is a conflicting tx in the blockchain or mempool
     bool CanAddSpendToMempool(const Scalar& coinSerial);
     bool CanAddMintToMempool(const GroupElement& pubCoin);
@@ -181,7 +320,7 @@ public:
     spend_info_container const & GetSpends() const;
     std::unordered_map<pair<CoinDenomination, int>, SigmaCoinGroupInfo, pairhash> const & GetCoinGroups() const ;
     std::unordered_map<CoinDenomination, int> const & GetLatestCoinIds() const;
-    std::unordered_map<Scalar, uint256, sigma::CScalarHash> const & GetMempoolCoinSerials() const;
+    flathashmap<Scalar, uint256, sigma::CScalarHash> const & GetMempoolCoinSerials() const;
 
     std::size_t GetTotalCoins() const { return GetMints().size(); }
 
@@ -191,12 +330,15 @@ private:
     // Collection of coin groups. Map from <denomination,id> to SigmaCoinGroupInfo structure
     std::unordered_map<pair<CoinDenomination, int>, SigmaCoinGroupInfo, pairhash> coinGroups;
 
+    // Public coin values of every coin group, kept in sync with coinGroups
+    std::unordered_map<pair<CoinDenomination, int>, SigmaCoinGroupSet, pairhash> coinGroupSets;
+
     // Latest IDs of coins by denomination
     std::unordered_map<CoinDenomination, int> latestCoinIds;
 
     // serials of spends currently in the mempool mapped to tx hashes
-    std::unordered_map<Scalar, uint256, CScalarHash> mempoolCoinSerials;
-    std::unordered_set<GroupElement> mempoolMints;
+    flathashmap<Scalar, uint256, CScalarHash> mempoolCoinSerials;
+    flathashset<GroupElement> mempoolMints;
     std::atomic<bool> surgeCondition;
 
     struct Containers {
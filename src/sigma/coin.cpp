@@ -182,6 +182,9 @@ PublicCoin::PublicCoin(const GroupElement& coin, const CoinDenomination d)
     : value(coin)
     , denomination(d)
 {
+    // Coins are compared, hashed and serialized far more often than created,
+    // keep the value affine so none of that needs a field inversion.
+    value.normalize();
 }
 
 const GroupElement& PublicCoin::getValue() const{
@@ -200,11 +203,14 @@ CoinDenomination PublicCoin::getDenomination() const {
 }
 
 bool PublicCoin::operator==(const PublicCoin& other) const{
+    // different cached hashes tell the coins apart without looking at the points
+    if (!valueHash.IsNull() && !other.valueHash.IsNull() && valueHash != other.valueHash)
+        return false;
     return (*this).value == other.value;
 }
 
 bool PublicCoin::operator!=(const PublicCoin& other) const{
-    return (*this).value != other.value;
+    return !(*this == other);
 }
 
 bool PublicCoin::validate() const{
@@ -293,7 +299,7 @@ void PrivateCoin::mintCoin(const CoinDenomination denomination){
 
     randomness.randomize();
     GroupElement commit = SigmaPrimitives<Scalar, GroupElement>::commit(
-            params->get_g(), serialNumber, params->get_h0(), randomness);
+            params->get_g(), serialNumber, params->get_h0(), randomness, params->get_tables());
     publicCoin = PublicCoin(commit, denomination);
 }
 
@@ -70,9 +70,11 @@ public:
         s.read(b, size + sizeof(int32_t));
         value.deserialize(buffer);
         std::memcpy(&denomination, buffer + size, sizeof(denomination));
+        valueHash.SetNull();
     }
 
 private:
+    // Kept in affine coordinates
     GroupElement value;
     CoinDenomination denomination;
     mutable uint256 valueHash;
@@ -25,9 +25,10 @@ CoinSpend::CoinSpend(
         params->get_g(),
         params->get_h(),
         params->get_n(),
-        params->get_m());
+        params->get_m(),
+        params->get_tables());
     //compute inverse of g^s
-    GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
+    GroupElement gs = params->get_tables()->get_g().get_multiple(coinSerialNumber).inverse();
     std::vector<GroupElement> C_;
     C_.reserve(anonymity_set.size());
     std::size_t coinIndex;
@@ -99,14 +100,23 @@ uint256 CoinSpend::signatureHash(const SpendMetaData& m) const {
 bool CoinSpend::Verify(
         const std::vector<sigma::PublicCoin>& anonymity_set,
         const SpendMetaData& m) const {
-    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m());
+    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m(),
+        params->get_tables());
     //compute inverse of g^s
-    GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
+    GroupElement gs = params->get_tables()->get_g().get_multiple(coinSerialNumber).inverse();
     std::vector<GroupElement> C_;
     C_.reserve(anonymity_set.size());
     for(std::size_t j = 0; j < anonymity_set.size(); ++j)
         C_.emplace_back(anonymity_set[j].getValue() + gs);
 
+    if (!HasValidSignature(m))
+        return false;
+
+    // Now verify the sigma proof itself.
+    return sigmaVerifier.verify(C_, sigmaProof);
+}
+
+bool CoinSpend::HasValidSignature(const SpendMetaData& m) const {
     uint256 metahash = signatureHash(m);
 
     // Verify ecdsa_signature, to make sure someone did not change the output of transaction.
@@ -142,8 +152,27 @@ bool CoinSpend::Verify(
         return false;
     }
 
-    // Now verify the sigma proof itself.
-    return sigmaVerifier.verify(C_, sigmaProof);
+    return true;
+}
+
+bool CoinSpend::BatchVerify(
+        const Params* p,
+        const GroupElement* anonymity_set,
+        size_t N,
+        const std::vector<size_t>& setSizes,
+        const std::vector<const CoinSpend*>& spends) {
+    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(p->get_g(), p->get_h(), p->get_n(), p->get_m(), p->get_tables());
+
+    std::vector<Scalar> serials;
+    std::vector<SigmaPlusProof<Scalar, GroupElement>> proofs;
+    serials.reserve(spends.size());
+    proofs.reserve(spends.size());
+    for (const CoinSpend* spend : spends) {
+        serials.emplace_back(spend->coinSerialNumber);
+        proofs.emplace_back(spend->sigmaProof);
+    }
+
+    return sigmaVerifier.batch_verify(anonymity_set, N, serials, setSizes, proofs);
 }
 
 const Scalar& CoinSpend::getCoinSerialNumber() {
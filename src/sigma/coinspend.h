@@ -51,6 +51,18 @@ public:
 
     bool Verify(const std::vector<sigma::PublicCoin>& anonymity_set, const SpendMetaData &m) const;
 
+    // Checks the ecdsa signature and the serial, but not the sigma proof.
+    bool HasValidSignature(const SpendMetaData& m) const;
+
+    // Verifies sigma proofs of several spends at once. The anonymity set of the i-th spend consists
+    // of the last setSizes[i] of N public coin values at anonymity_set. Signatures are not checked.
+    static bool BatchVerify(
+            const Params* p,
+            const GroupElement* anonymity_set,
+            size_t N,
+            const std::vector<size_t>& setSizes,
+            const std::vector<const CoinSpend*>& spends);
+
     ADD_SERIALIZE_METHODS;
     template <typename Stream, typename Operation>
     void SerializationOp(Stream& s, Operation ser_action, int nType, int nVersion) {
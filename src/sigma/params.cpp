@@ -71,4 +71,9 @@ uint64_t Params::get_m() const{
     return m_;
 }
 
+const GeneratorTables* Params::get_tables() const{
+    std::call_once(tables_flag_, [this] { tables_.reset(new GeneratorTables(g_, h_)); });
+    return tables_.get();
+}
+
 } //namespace sigma
@@ -3,6 +3,10 @@
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
 #include <serialize.h>
+#include "sigma_primitives.h"
+
+#include <memory>
+#include <mutex>
 
 using namespace secp_primitives;
 
@@ -16,6 +20,8 @@ public:
     const std::vector<GroupElement>& get_h() const;
     uint64_t get_n() const;
     uint64_t get_m() const;
+    // Precomputed multiples of g and h, built on the first call
+    const GeneratorTables* get_tables() const;
 
 private:
    Params(const GroupElement& g, int n, int m);
@@ -27,6 +33,8 @@ private:
     std::vector<GroupElement> h_;
     int m_;
     int n_;
+    mutable std::once_flag tables_flag_;
+    mutable std::unique_ptr<GeneratorTables> tables_;
 };
 
 }//namespace sigma
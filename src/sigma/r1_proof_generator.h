@@ -15,7 +15,8 @@ public:
                      const std::vector<Exponent>& b,
                      const Exponent& r,
                      int n,
-                     int m);
+                     int m,
+                     const GeneratorTables* tables = nullptr);
 
     // Returns commitment B.
     const GroupElement& get_B() const;
@@ -66,6 +67,8 @@ private:
     // Size of the matrix for commitment. Number of coins N < n^m.
     int n_;
     int m_;
+    // Precomputed multiples of g_ and h_, optional
+    const GeneratorTables* tables_;
 
 };
 
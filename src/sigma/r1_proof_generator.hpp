@@ -7,15 +7,17 @@ R1ProofGenerator<Exponent,GroupElement>::R1ProofGenerator(
         const std::vector<Exponent>& b,
         const Exponent& r,
         int n ,
-        int m)
+        int m,
+        const GeneratorTables* tables)
     : g_(g)
     , h_(h_gens)
     , b_(b)
     , r(r)
     , n_(n)
     , m_(m)
+    , tables_(tables)
 {
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, b_, r, B_Commit);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, b_, r, B_Commit, tables_);
 }
 
 template<class Exponent, class GroupElement>
@@ -50,7 +52,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
 
     //compute A
     GroupElement A;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, a_out, rA_, A);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, a_out, rA_, A, tables_);
     proof_out.A_ = A;
 
     //compute C
@@ -60,7 +62,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
         c[i] = (a_out[i] * (Exponent(uint64_t(1)) - (Exponent(uint64_t(2)) * b_[i])));
     }
     GroupElement C;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, c, rC_, C);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, c, rC_, C, tables_);
     proof_out.C_ = C;
 
     //compute D
@@ -70,7 +72,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
         d[i] = ((a_out[i].square()).negate());
     }
     GroupElement D;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_,h_, d, rD_, D);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_,h_, d, rD_, D, tables_);
 
     proof_out.D_ = D;
 
@@ -1,6 +1,8 @@
 #ifndef GRAVITYCOIN_SIGMA_R1_PROOF_VERIFIER_H
 #define GRAVITYCOIN_SIGMA_R1_PROOF_VERIFIER_H
 
+#include "sigma_primitives.h"
+
 namespace sigma {
 
 template <class Exponent, class GroupElement>
@@ -9,7 +11,8 @@ class R1ProofVerifier {
 public:
     R1ProofVerifier(const GroupElement& g,
             const std::vector<GroupElement>& h_gens,
-            const GroupElement& B, int n , int m);
+            const GroupElement& B, int n , int m,
+            const GeneratorTables* tables = nullptr);
 
     bool verify(const R1Proof<Exponent, GroupElement>& proof,
                 bool skip_final_response_verification = false) const;
@@ -29,6 +32,8 @@ private:
     GroupElement B_Commit;
     int n_;
     int m_;
+    // Precomputed multiples of g_ and h_, optional
+    const GeneratorTables* tables_;
 };
 
 } // namespace sigma
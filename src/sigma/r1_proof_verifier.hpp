@@ -6,12 +6,14 @@ R1ProofVerifier<Exponent,GroupElement>::R1ProofVerifier(
         const std::vector<GroupElement>& h_gens,
         const GroupElement& B,
         int n ,
-        int m)
+        int m,
+        const GeneratorTables* tables)
     : g_(g)
     , h_(h_gens)
     , B_Commit(B)
     , n_(n)
-    , m_(m){
+    , m_(m)
+    , tables_(tables){
 }
 
 template<class Exponent, class GroupElement>
@@ -72,7 +74,7 @@ bool R1ProofVerifier<Exponent,GroupElement>::verify_final_response(
     }
 
     GroupElement one;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_out, proof.ZA_, one);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_out, proof.ZA_, one, tables_);
     if((B_Commit * challenge_x + proof.A_) != one)
         return false;
 
@@ -83,7 +85,7 @@ bool R1ProofVerifier<Exponent,GroupElement>::verify_final_response(
     }
 
     GroupElement two;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_outprime, proof.ZC_, two);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_outprime, proof.ZC_, two, tables_);
     if ((proof.C_ * challenge_x + proof.D_) != two)
         return false;
 
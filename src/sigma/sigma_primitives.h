@@ -2,6 +2,7 @@
 #define GRAVITYCOIN_SIGMA_SIGMA_PRIMITIVES_H
 
 #include "../secp256k1/include/MultiExponent.h"
+#include "../secp256k1/include/FixedBaseExponent.h"
 #include "../secp256k1/include/GroupElement.h"
 #include "../secp256k1/include/Scalar.h"
 
@@ -10,17 +11,42 @@
 
 namespace sigma {
 
+/** Precomputed multiples of the commitment generators g and h, products of them with scalars
+ *  take a fraction of the time of GroupElement::operator* and MultiExponent.
+ */
+class GeneratorTables {
+public:
+    GeneratorTables(const secp_primitives::GroupElement& g, const std::vector<secp_primitives::GroupElement>& h);
+
+    const secp_primitives::FixedBaseExponent& get_g() const;
+
+    // result_out += g * r + sum(h[i] * exp[i])
+    void commit(const std::vector<secp_primitives::Scalar>& exp,
+            const secp_primitives::Scalar& r,
+            secp_primitives::GroupElement& result_out) const;
+
+    // g * m + h[0] * r
+    secp_primitives::GroupElement commit(const secp_primitives::Scalar& m, const secp_primitives::Scalar& r) const;
+
+private:
+    secp_primitives::FixedBaseExponent g_;
+    std::vector<secp_primitives::FixedBaseExponent> h_;
+};
+
 template<class Exponent, class GroupElement>
 class SigmaPrimitives {
 
 public:
+    // If tables are given they must be built for the same g and h
     static void commit(const GroupElement& g,
             const std::vector<GroupElement>& h,
             const std::vector<Exponent>& exp,
             const Exponent& r,
-            GroupElement& result_out);
+            GroupElement& result_out,
+            const GeneratorTables* tables = nullptr);
 
-    static GroupElement commit(const GroupElement& g, const Exponent m, const GroupElement h, const Exponent r);
+    static GroupElement commit(const GroupElement& g, const Exponent m, const GroupElement h, const Exponent r,
+            const GeneratorTables* tables = nullptr);
 
     static void convert_to_sigma(uint64_t num, uint64_t n, uint64_t m, std::vector<Exponent>& out);
 
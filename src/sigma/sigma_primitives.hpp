@@ -2,12 +2,48 @@
 
 namespace sigma {
 
+inline GeneratorTables::GeneratorTables(
+        const secp_primitives::GroupElement& g,
+        const std::vector<secp_primitives::GroupElement>& h)
+    : g_(g) {
+    h_.reserve(h.size());
+    for (const secp_primitives::GroupElement& h_i : h)
+        h_.emplace_back(h_i);
+}
+
+inline const secp_primitives::FixedBaseExponent& GeneratorTables::get_g() const {
+    return g_;
+}
+
+inline void GeneratorTables::commit(
+        const std::vector<secp_primitives::Scalar>& exp,
+        const secp_primitives::Scalar& r,
+        secp_primitives::GroupElement& result_out) const {
+    g_.add_multiple(result_out, r);
+    for (std::size_t i = 0; i < h_.size(); ++i)
+        h_[i].add_multiple(result_out, exp[i]);
+}
+
+inline secp_primitives::GroupElement GeneratorTables::commit(
+        const secp_primitives::Scalar& m,
+        const secp_primitives::Scalar& r) const {
+    secp_primitives::GroupElement result;
+    g_.add_multiple(result, m);
+    h_[0].add_multiple(result, r);
+    return result;
+}
+
 template<class Exponent, class GroupElement>
 void SigmaPrimitives<Exponent, GroupElement>::commit(const GroupElement& g,
         const std::vector<GroupElement>& h,
         const std::vector<Exponent>& exp,
         const Exponent& r,
-        GroupElement& result_out) {
+        GroupElement& result_out,
+        const GeneratorTables* tables) {
+    if (tables) {
+        tables->commit(exp, r, result_out);
+        return;
+    }
     secp_primitives::MultiExponent mult(h, exp);
     result_out += g * r + mult.get_multiple();
 }
@@ -17,7 +53,10 @@ GroupElement SigmaPrimitives<Exponent, GroupElement>::commit(
         const GroupElement& g,
         const Exponent m,
         const GroupElement h,
-        const Exponent r){
+        const Exponent r,
+        const GeneratorTables* tables){
+    if (tables)
+        return tables->commit(m, r);
     return g * m + h * r;
 }
 
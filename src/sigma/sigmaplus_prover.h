@@ -4,16 +4,22 @@
 #include "r1_proof_generator.h"
 #include "sigmaplus_proof.h"
 
+#include "../libzerocoin/ParallelTasks.h"
+
 #include <cstddef>
 
 namespace sigma {
 
+// Smallest number of commits handed to one task while generating a proof.
+static const std::size_t SIGMA_PROVER_MIN_CHUNK = 1024;
+
 template <class Exponent, class GroupElement>
 class SigmaPlusProver{
 
 public:
     SigmaPlusProver(const GroupElement& g,
-                    const std::vector<GroupElement>& h_gens, int n, int m);
+                    const std::vector<GroupElement>& h_gens, int n, int m,
+                    const GeneratorTables* tables = nullptr);
     void proof(const std::vector<GroupElement>& commits,
                std::size_t l,
                const Exponent& r,
@@ -24,6 +30,8 @@ private:
     std::vector<GroupElement> h_;
     int n_;
     int m_;
+    // Precomputed multiples of g_ and h_, optional
+    const GeneratorTables* tables_;
 };
 
 } // namespace sigma
@@ -5,11 +5,13 @@ SigmaPlusProver<Exponent, GroupElement>::SigmaPlusProver(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         int n,
-        int m)
+        int m,
+        const GeneratorTables* tables)
     : g_(g)
     , h_(h_gens)
     , n_(n)
-    , m_(m) {
+    , m_(m)
+    , tables_(tables) {
 }
 
 template<class Exponent, class GroupElement>
@@ -32,46 +34,83 @@ void SigmaPlusProver<Exponent, GroupElement>::proof(
     for (int k = 0; k < m_; ++k) {
         Pk[k].randomize();
     }
-    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_);
+    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_, tables_);
     proof_out.B_ = r1prover.get_B();
     std::vector<Exponent> a;
     r1prover.proof(a, proof_out.r1Proof_, true /*Skip generation of final response*/);
 
-    // Compute coefficients of Polynomials P_I(x), for all I from [0..N].
-    std::vector <std::vector<Exponent>> P_i_k;
-    P_i_k.resize(N);
-    for (std::size_t i = 0; i < N; ++i) {
-        std::vector<Exponent>& coefficients = P_i_k[i];
-        std::vector<uint64_t> I = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(i, n_, m_);
-        coefficients.push_back(sigma[I[0]]);
-        coefficients.push_back(a[I[0]]);
-        for (int j = 1; j < m_; ++j) {
-            SigmaPrimitives<Exponent, GroupElement>::new_factor(sigma[j * n_ + I[j]], a[j * n_ + I[j]], coefficients);
+    // The work below is split across the libzerocoin thread pool. When the proof
+    // itself runs on the pool (several spends at once), the waiting pool thread
+    // runs queued tasks too, so the other proofs' threads still join in.
+    std::size_t threads = std::max(1u, boost::thread::hardware_concurrency());
+
+    // Compute coefficients of Polynomials P_I(x), for all I from [0..N], stored
+    // as P_k[k][i] so every G_k below multiplies the commits by one row.
+    std::vector<std::vector<Exponent>> P_k(m_, std::vector<Exponent>(N));
+    std::size_t chunk_size = std::max(SIGMA_PROVER_MIN_CHUNK, (N + threads - 1) / threads);
+    libzerocoin::ParallelTasks coefficient_tasks(threads);
+    for (std::size_t begin = 0; begin < N; begin += chunk_size) {
+        std::size_t end = std::min(N, begin + chunk_size);
+        coefficient_tasks.Add([&, begin, end]() {
+            for (std::size_t i = begin; i < end; ++i) {
+                std::vector<Exponent> coefficients;
+                std::vector<uint64_t> I = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(i, n_, m_);
+                coefficients.push_back(sigma[I[0]]);
+                coefficients.push_back(a[I[0]]);
+                for (int j = 1; j < m_; ++j) {
+                    SigmaPrimitives<Exponent, GroupElement>::new_factor(sigma[j * n_ + I[j]], a[j * n_ + I[j]], coefficients);
+                }
+                std::reverse(coefficients.begin(), coefficients.end());
+                for (int k = 0; k < m_; ++k) {
+                    P_k[k][i] = coefficients[k];
+                }
+            }
+        });
+    }
+    coefficient_tasks.Wait();
+
+    //computing G_k`s, each multiexponentiation split into ranges of the commits;
+    std::size_t ranges = (threads + m_ - 1) / m_;
+    std::size_t range_size = std::max(SIGMA_PROVER_MIN_CHUNK, (N + ranges - 1) / ranges);
+    ranges = (N + range_size - 1) / range_size;
+    std::vector<GroupElement> partial(m_ * ranges);
+    libzerocoin::ParallelTasks multiexp_tasks(m_ * ranges);
+    for (int k = 0; k < m_; ++k) {
+        for (std::size_t j = 0; j < ranges; ++j) {
+            multiexp_tasks.Add([&, k, j]() {
+                std::size_t begin = j * range_size;
+                std::size_t end = std::min(N, begin + range_size);
+                secp_primitives::MultiExponent mult(commits.data() + begin, P_k[k].data() + begin, end - begin);
+                partial[k * ranges + j] = mult.get_multiple();
+            });
         }
-        std::reverse(coefficients.begin(), coefficients.end());
     }
+    multiexp_tasks.Wait();
 
-    //computing G_k`s;
     std::vector <GroupElement> Gk;
     Gk.reserve(m_);
     for (int k = 0; k < m_; ++k) {
-        std::vector <Exponent> P_i;
-        P_i.reserve(N);
-        for (size_t i = 0; i < N; ++i) {
-            P_i.emplace_back(P_i_k[i][k]);
+        GroupElement c_k = SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], Pk[k], tables_);
+        for (std::size_t j = 0; j < ranges; ++j) {
+            c_k += partial[k * ranges + j];
         }
-        secp_primitives::MultiExponent mult(commits, P_i);
-        GroupElement c_k = mult.get_multiple();
-        c_k += SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], Pk[k]);
         Gk.emplace_back(c_k);
     }
     proof_out.Gk_ = Gk;
 
+    // The proof points are hashed for the challenge and serialized afterwards,
+    // bring them to affine coordinates at the cost of one field inversion.
+    std::vector<GroupElement*> proof_points = {
+        &proof_out.r1Proof_.A_, &proof_out.B_, &proof_out.r1Proof_.C_, &proof_out.r1Proof_.D_};
+    for (auto& G : proof_out.Gk_)
+        proof_points.push_back(&G);
+    GroupElement::normalize_batch(proof_points);
+
     // Compute value of challenge X, then continue R1 proof and sigma final response proof.
     std::vector<GroupElement> group_elements = {
         proof_out.r1Proof_.A_, proof_out.B_, proof_out.r1Proof_.C_, proof_out.r1Proof_.D_};
 
-    group_elements.insert(group_elements.end(), Gk.begin(), Gk.end());
+    group_elements.insert(group_elements.end(), proof_out.Gk_.begin(), proof_out.Gk_.end());
     Exponent x;
     SigmaPrimitives<Exponent, GroupElement>::generate_challenge(group_elements, x);
     r1prover.generate_final_response(a, x, proof_out.r1Proof_);
@@ -11,16 +11,41 @@ class SigmaPlusVerifier{
 public:
     SigmaPlusVerifier(const GroupElement& g,
                       const std::vector<GroupElement>& h_gens,
-                      int n, int m_);
+                      int n, int m_,
+                      const GeneratorTables* tables = nullptr);
 
     bool verify(const std::vector<GroupElement>& commits,
                 const SigmaPlusProof<Exponent, GroupElement>& proof) const;
 
+    /** \brief Verifies several proofs over the same anonymity set with a single multiexponentiation.
+     *  \param[in] commits Public coins of the anonymity set, not shifted by the serials.
+     *  \param[in] N Number of elements in commits.
+     *  \param[in] serials Serial number of the coin spent by each proof.
+     *  \param[in] setSizes Each proof was made over the last setSizes[i] elements of commits.
+     *  \returns true only if all the proofs are valid, but does not tell which one failed.
+     */
+    bool batch_verify(const GroupElement* commits,
+                      std::size_t N,
+                      const std::vector<Exponent>& serials,
+                      const std::vector<std::size_t>& setSizes,
+                      const std::vector<SigmaPlusProof<Exponent, GroupElement>>& proofs) const;
+
 private:
+    // Runs all the checks except the final one over the anonymity set,
+    // returns the challenge and the finalized values of f for the final check.
+    bool verify_challenge(const SigmaPlusProof<Exponent, GroupElement>& proof,
+                          Exponent& challenge_x,
+                          std::vector<Exponent>& f) const;
+
+    // Computes the exponents of the first N commits in the final check.
+    void compute_fis(const std::vector<Exponent>& f, int N, std::vector<Exponent>& f_i_) const;
+
     GroupElement g_;
     std::vector<GroupElement> h_;
     int n;
     int m;
+    // Precomputed multiples of g_ and h_, optional
+    const GeneratorTables* tables_;
 };
 
 } // namespace sigma
@@ -4,11 +4,13 @@ SigmaPlusVerifier<Exponent, GroupElement>::SigmaPlusVerifier(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         int n,
-        int m)
+        int m,
+        const GeneratorTables* tables)
     : g_(g)
     , h_(h_gens)
     , n(n)
-    , m(m){
+    , m(m)
+    , tables_(tables){
 }
 
 template<class Exponent, class GroupElement>
@@ -16,8 +18,113 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         const std::vector<GroupElement>& commits,
         const SigmaPlusProof<Exponent, GroupElement>& proof) const {
 
-    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m);
+    Exponent challenge_x;
     std::vector<Exponent> f;
+    if (!verify_challenge(proof, challenge_x, f))
+        return false;
+
+    int N = commits.size();
+    std::vector<Exponent> f_i_;
+    compute_fis(f, N, f_i_);
+
+    const std::vector <GroupElement>& Gk = proof.Gk_;
+    secp_primitives::MultiExponent mult(commits, f_i_);
+    GroupElement t1 = mult.get_multiple();
+    GroupElement t2;
+    Exponent x_k(uint64_t(1));
+    for(int k = 0; k < m; ++k){
+        t2 += (Gk[k] * (x_k.negate()));
+        x_k *= challenge_x;
+    }
+
+    GroupElement left(t1 + t2);
+    if (left != SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], proof.z_, tables_)) {
+        LogPrintf("Sigma spend failed due to final proof verification failure.");
+        return false;
+    }
+
+    return true;
+}
+
+template<class Exponent, class GroupElement>
+bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
+        const GroupElement* commits,
+        std::size_t N,
+        const std::vector<Exponent>& serials,
+        const std::vector<std::size_t>& setSizes,
+        const std::vector<SigmaPlusProof<Exponent, GroupElement>>& proofs) const {
+    std::size_t M = proofs.size();
+    if (serials.size() != M || setSizes.size() != M)
+        return false;
+
+    // Final check of every proof t is
+    //     sum_i(f_i * (commits[i] - g * s_t)) - sum_k(Gk[k] * x^k) - h_0 * z == 0,
+    // each one is multiplied by a random weight y_t and all of them are summed up,
+    // so the whole batch costs one multiexponentiation over the set. The set is
+    // passed to MultiExponent as is, the proof points go to a second, small one.
+    std::vector<Exponent> exponents(N, Exponent(uint64_t(0)));
+    std::vector<GroupElement> points;
+    std::vector<Exponent> point_exponents;
+    points.reserve(M * m + 2);
+    point_exponents.reserve(M * m + 2);
+
+    Exponent g_exp(uint64_t(0)), h0_exp(uint64_t(0));
+    for (std::size_t t = 0; t < M; ++t) {
+        if (setSizes[t] > N) {
+            LogPrintf("Sigma spend failed due to anonymity set larger than the batch set.");
+            return false;
+        }
+
+        Exponent challenge_x;
+        std::vector<Exponent> f;
+        if (!verify_challenge(proofs[t], challenge_x, f))
+            return false;
+
+        std::vector<Exponent> f_i_;
+        compute_fis(f, setSizes[t], f_i_);
+
+        Exponent y;
+        y.randomize();
+
+        std::size_t offset = N - setSizes[t];
+        Exponent f_sum(uint64_t(0));
+        for (std::size_t i = 0; i < setSizes[t]; ++i) {
+            exponents[offset + i] += y * f_i_[i];
+            f_sum += f_i_[i];
+        }
+        g_exp -= y * serials[t] * f_sum;
+        h0_exp -= y * proofs[t].z_;
+
+        Exponent x_k(y);
+        for (int k = 0; k < m; ++k) {
+            points.emplace_back(proofs[t].Gk_[k]);
+            point_exponents.emplace_back(x_k.negate());
+            x_k *= challenge_x;
+        }
+    }
+
+    points.emplace_back(g_);
+    point_exponents.emplace_back(g_exp);
+    points.emplace_back(h_[0]);
+    point_exponents.emplace_back(h0_exp);
+
+    secp_primitives::MultiExponent set_mult(commits, exponents.data(), N);
+    secp_primitives::MultiExponent points_mult(points, point_exponents);
+    if (!(set_mult.get_multiple() + points_mult.get_multiple()).isInfinity()) {
+        LogPrintf("Sigma spend failed due to final batch verification failure.");
+        return false;
+    }
+
+    return true;
+}
+
+template<class Exponent, class GroupElement>
+bool SigmaPlusVerifier<Exponent, GroupElement>::verify_challenge(
+        const SigmaPlusProof<Exponent, GroupElement>& proof,
+        Exponent& challenge_x,
+        std::vector<Exponent>& f) const {
+
+    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m, tables_);
     const R1Proof<Exponent, GroupElement>& r1Proof = proof.r1Proof_;
     if (!r1ProofVerifier.verify(r1Proof, f, true /* Skip verification of final response */)) {
         LogPrintf("Sigma spend failed due to r1 proof incorrect.");
@@ -42,7 +149,6 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         r1Proof.A_, proof.B_, r1Proof.C_, r1Proof.D_};
 
     group_elements.insert(group_elements.end(), Gk.begin(), Gk.end());
-    Exponent challenge_x;
     SigmaPrimitives<Exponent, GroupElement>::generate_challenge(group_elements, challenge_x);
 
     // Now verify the final response of r1 proof. Values of "f" are finalized only after this call.
@@ -56,8 +162,15 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         return false;
     }
 
-    int N = commits.size();
-    std::vector<Exponent> f_i_;
+    return true;
+}
+
+template<class Exponent, class GroupElement>
+void SigmaPlusVerifier<Exponent, GroupElement>::compute_fis(
+        const std::vector<Exponent>& f,
+        int N,
+        std::vector<Exponent>& f_i_) const {
+    f_i_.clear();
     f_i_.reserve(N);
     for(int i = 0; i < N; ++i) {
         std::vector<uint64_t> I = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(i, n, m);
@@ -67,23 +180,6 @@ bool SigmaPlusVerifier<Exponent, GroupElement>::verify(
         }
         f_i_.emplace_back(f_i);
     }
-
-    secp_primitives::MultiExponent mult(commits, f_i_);
-    GroupElement t1 = mult.get_multiple();
-    GroupElement t2;
-    Exponent x_k(uint64_t(1));
-    for(int k = 0; k < m; ++k){
-        t2 += (Gk[k] * (x_k.negate()));
-        x_k *= challenge_x;
-    }
-
-    GroupElement left(t1 + t2);
-    if (left != SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], proof.z_)) {
-        LogPrintf("Sigma spend failed due to final proof verification failure.");
-        return false;
-    }
-
-    return true;
 }
 
 } // namespace sigma
@@ -12,11 +12,14 @@
 #include "main.h"
 #include "consensus/consensus.h"
 #include "base58.h"
+#include "libzerocoin/ParallelTasks.h"
 
 #include <stdint.h>
 
 #include <boost/thread.hpp>
 
+#include <deque>
+
 using namespace std;
 
 static const char DB_COINS = 'c';
@@ -33,6 +36,7 @@ static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 static const char DB_TOTAL_SUPPLY = 'S';
+static const char DB_SIGMA_BLOCK_DATA = 'z';
 
 
 CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe, true)
@@ -144,7 +148,8 @@ void CCoinsViewDBCursor::Next()
         keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
 }
 
-bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo) {
+bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                                  const std::vector<std::pair<const CBlockIndex*, const sigma::CSigmaBlockData*> >& sigmaBlockData) {
     CDBBatch batch(*this);
     for (std::vector<std::pair<int, const CBlockFileInfo*> >::const_iterator it=fileInfo.begin(); it != fileInfo.end(); it++) {
         batch.Write(make_pair(DB_BLOCK_FILES, it->first), *it->second);
@@ -153,9 +158,38 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
     	batch.Write(make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it));
     }
+    for (const auto& entry : sigmaBlockData) {
+        batch.Write(make_pair(DB_SIGMA_BLOCK_DATA, CSigmaBlockDataKey(entry.first->nHeight, entry.first->GetBlockHash())), *entry.second);
+    }
     return WriteBatch(batch, true);
 }
 
+bool CBlockTreeDB::ReadSigmaBlockData(const CBlockIndex *pindex, sigma::CSigmaBlockData &data) {
+    return Read(make_pair(DB_SIGMA_BLOCK_DATA, CSigmaBlockDataKey(pindex->nHeight, pindex->GetBlockHash())), data);
+}
+
+bool CBlockTreeDB::LoadSigmaBlockData(int nStartHeight, boost::function<void(int, const uint256&, const sigma::CSigmaBlockData&)> callback) {
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(make_pair(DB_SIGMA_BLOCK_DATA, CSigmaBlockDataKey(nStartHeight, uint256())));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CSigmaBlockDataKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_SIGMA_BLOCK_DATA) {
+            sigma::CSigmaBlockData data;
+            if (!pcursor->GetValue(data))
+                return error("LoadSigmaBlockData() : failed to read value");
+            callback(key.second.nHeight, key.second.blockHash, data);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
 bool CBlockTreeDB::ReadTxIndex(const uint256 &txid, CDiskTxPos &pos) {
     return Read(make_pair(DB_TXINDEX, txid), pos);
 }
@@ -308,6 +342,62 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
+namespace {
+
+// Number of block index entries deserialized by one task of LoadBlockIndexGuts
+static const size_t BLOCK_INDEX_LOAD_BATCH_SIZE = 4096;
+
+// Block index entries read from the database by LoadBlockIndexGuts. Values are deserialized by the
+// thread pool while next entries are read, entries are then linked in the database order
+class CBlockIndexLoadBatch
+{
+public:
+    std::vector<uint256> keys;
+    std::vector<CDataStream> values;
+    std::vector<CDiskBlockIndex> entries;
+    std::vector<uint256> hashes;
+    bool fValid;
+
+    CBlockIndexLoadBatch() : fValid(true), fDecoding(false) {}
+
+    ~CBlockIndexLoadBatch() {
+        // the task refers to the batch, it must not outlive it
+        Wait();
+    }
+
+    void StartDecoding() {
+        fDecoding = true;
+        decoding.Add([this] { Decode(); });
+    }
+
+    void Wait() {
+        if (fDecoding) {
+            decoding.Wait();
+            fDecoding = false;
+        }
+    }
+
+private:
+    libzerocoin::ParallelTasks decoding;
+    bool fDecoding;
+
+    void Decode() {
+        entries.resize(values.size());
+        hashes.resize(values.size());
+        try {
+            for (size_t i = 0; i < values.size(); i++) {
+                values[i] >> entries[i];
+                hashes[i] = entries[i].GetBlockHash();
+            }
+        } catch (const std::exception&) {
+            fValid = false;
+        }
+        values.clear();
+    }
+};
+
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex)
 {
     auto consensusParams = Params().GetConsensus();
@@ -317,14 +407,43 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
 
     pcursor->Seek(make_pair(DB_BLOCK_INDEX, uint256()));
 
+    // Entries of older clients have their sigma data moved out of the block index
+    boost::scoped_ptr<CDBBatch> upgradeBatch(new CDBBatch(*this));
+    size_t nUpgraded = 0;
+
+    // Batches being deserialized, enough of them are kept in flight to keep the thread pool busy
+    std::deque<std::unique_ptr<CBlockIndexLoadBatch>> batches;
+    std::unique_ptr<CBlockIndexLoadBatch> batch(new CBlockIndexLoadBatch);
+    size_t nMaxBatches = 2 * std::max(GetNumCores(), 1);
+
     // Load mapBlockIndex
-    while (pcursor->Valid()) {
+    for (bool fEnd = false; !fEnd; ) {
         boost::this_thread::interruption_point();
         std::pair<char, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                CBlockIndex* pindexNew    = insertBlockIndex(diskindex.GetBlockHash());
+        if (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
+            batch->keys.push_back(key.second);
+            batch->values.emplace_back(SER_DISK, CLIENT_VERSION);
+            pcursor->GetValueStream(batch->values.back());
+            pcursor->Next();
+        } else {
+            fEnd = true;
+        }
+
+        if (batch->keys.size() == BLOCK_INDEX_LOAD_BATCH_SIZE || (fEnd && !batch->keys.empty())) {
+            batch->StartDecoding();
+            batches.push_back(std::move(batch));
+            batch.reset(new CBlockIndexLoadBatch);
+        }
+
+        while (!batches.empty() && (fEnd || batches.size() > nMaxBatches)) {
+            CBlockIndexLoadBatch &loaded = *batches.front();
+            loaded.Wait();
+            if (!loaded.fValid)
+                return error("LoadBlockIndex() : failed to read value");
+
+            for (size_t i = 0; i < loaded.keys.size(); i++) {
+                CDiskBlockIndex &diskindex = loaded.entries[i];
+                CBlockIndex* pindexNew    = insertBlockIndex(loaded.hashes[i]);
                 pindexNew->pprev 		  = insertBlockIndex(diskindex.hashPrev);
 
                 pindexNew->nHeight        = diskindex.nHeight;
@@ -338,18 +457,37 @@ bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256
                 pindexNew->nNonce         = diskindex.nNonce;
                 pindexNew->nStatus        = diskindex.nStatus;
                 pindexNew->nTx            = diskindex.nTx;
-                pindexNew->sigmaMintedPubCoins   = diskindex.sigmaMintedPubCoins;
-                pindexNew->sigmaSpentSerials     = diskindex.sigmaSpentSerials;
-
-                pcursor->Next();
-            } else {
-                return error("LoadBlockIndex() : failed to read value");
+                pindexNew->powHash        = diskindex.powHash;
+
+                if (diskindex.nDiskBlockVersion < SIGMA_BLOCK_DATA_INDEX_VERSION) {
+                    // Older clients left empty mint lists behind, the new records only keep groups with mints
+                    auto& legacyMints = diskindex.legacySigmaData.mints;
+                    for (auto it = legacyMints.begin(); it != legacyMints.end(); ) {
+                        if (it->second.empty())
+                            it = legacyMints.erase(it);
+                        else
+                            ++it;
+                    }
+                    if (!diskindex.legacySigmaData.IsEmpty())
+                        upgradeBatch->Write(make_pair(DB_SIGMA_BLOCK_DATA, CSigmaBlockDataKey(diskindex.nHeight, loaded.keys[i])), diskindex.legacySigmaData);
+                    upgradeBatch->Write(make_pair(DB_BLOCK_INDEX, loaded.keys[i]), CDiskBlockIndex(pindexNew));
+                    if (++nUpgraded % 10000 == 0) {
+                        if (!WriteBatch(*upgradeBatch))
+                            return error("LoadBlockIndex() : failed to upgrade block index");
+                        upgradeBatch.reset(new CDBBatch(*this));
+                    }
+                }
             }
-        } else {
-            break;
+            batches.pop_front();
         }
     }
 
+    if (nUpgraded > 0) {
+        if (!WriteBatch(*upgradeBatch, true))
+            return error("LoadBlockIndex() : failed to upgrade block index");
+        LogPrintf("%s: moved sigma data of %u block index entries out of the index\n", __func__, nUpgraded);
+    }
+
     return true;
 }
 
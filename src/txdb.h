@@ -62,6 +62,31 @@ struct CDiskTxPos : public CDiskBlockPos
     }
 };
 
+/** Key of sigma::CSigmaBlockData records, height goes first in big endian so records are iterated in height order */
+struct CSigmaBlockDataKey
+{
+    int nHeight;
+    uint256 blockHash;
+
+    size_t GetSerializeSize(int nType, int nVersion) const {
+        return 36;
+    }
+    template<typename Stream>
+    void Serialize(Stream& s, int nType, int nVersion) const {
+        ser_writedata32be(s, nHeight);
+        blockHash.Serialize(s, nType, nVersion);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s, int nType, int nVersion) {
+        nHeight = ser_readdata32be(s);
+        blockHash.Unserialize(s, nType, nVersion);
+    }
+
+    CSigmaBlockDataKey(int nHeightIn, const uint256 &blockHashIn) : nHeight(nHeightIn), blockHash(blockHashIn) {}
+
+    CSigmaBlockDataKey() : nHeight(0) {}
+};
+
 /** CCoinsView backed by the coin database (chainstate/) */
 class CCoinsViewDB : public CCoinsView
 {
@@ -108,7 +133,8 @@ private:
     CBlockTreeDB(const CBlockTreeDB&);
     void operator=(const CBlockTreeDB&);
 public:
-    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
+    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo,
+                        const std::vector<std::pair<const CBlockIndex*, const sigma::CSigmaBlockData*> >& sigmaBlockData);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &fileinfo);
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindex);
@@ -131,6 +157,9 @@ public:
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
     bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+    bool ReadSigmaBlockData(const CBlockIndex *pindex, sigma::CSigmaBlockData &data);
+    //! Pass sigma data of all the blocks at nStartHeight or above having some to callback, in height order
+    bool LoadSigmaBlockData(int nStartHeight, boost::function<void(int, const uint256&, const sigma::CSigmaBlockData&)> callback);
     int GetBlockIndexVersion();
     int GetBlockIndexVersion(uint256 const & blockHash);
     bool AddTotalSupply(CAmount const & supply);
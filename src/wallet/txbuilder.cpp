@@ -9,6 +9,8 @@
 #include "../uint256.h"
 #include "../util.h"
 
+#include "../libzerocoin/ParallelTasks.h"
+
 #include <boost/format.hpp>
 
 #include <algorithm>
@@ -217,8 +219,24 @@ CWalletTx TxBuilder::Build(const std::vector<CRecipient>& recipients, CAmount& f
         // now every fields is populated then we can sign transaction
         uint256 sig = tx.GetHash();
 
+        // signers are independent of each other and a sigma spend proof takes seconds, sign in parallel.
+        // A single input is signed here, so the proof spreads its own work over the pool
+        std::vector<CScript> scripts(tx.vin.size());
+
+        if (tx.vin.size() == 1) {
+            scripts[0] = signers[0]->Sign(tx, sig);
+        } else {
+            libzerocoin::ParallelTasks signing(tx.vin.size());
+
+            for (size_t i = 0; i < tx.vin.size(); i++) {
+                signing.Add([&, i] { scripts[i] = signers[i]->Sign(tx, sig); });
+            }
+
+            signing.Wait();
+        }
+
         for (size_t i = 0; i < tx.vin.size(); i++) {
-            tx.vin[i].scriptSig = signers[i]->Sign(tx, sig);
+            tx.vin[i].scriptSig = std::move(scripts[i]);
         }
 
         // check fee
@@ -21,6 +21,7 @@
 #include "../sigma/spend_metadata.h"
 #include "../sigma/coin.h"
 #include "../libzerocoin/SpendMetaData.h"
+#include "../libzerocoin/ParallelTasks.h"
 #include "net.h"
 #include "policy/policy.h"
 #include "primitives/block.h"
@@ -4943,31 +4944,47 @@ bool CWallet::CreateMultipleSigmaSpendTransaction(
 
             uint256 txHashForMetadata = txTemp.GetHash();
             LogPrintf("txNew.GetHash: %s\n", txHashForMetadata.ToString());
+            // Create and verify CoinSpend objects in parallel, each one is a proof over the whole anonymity set
+            std::vector<std::unique_ptr<sigma::CoinSpend>> createdSpends(denominations.size());
+            std::vector<char> verifiedSpends(denominations.size(), false);
+            auto createSpend = [&](size_t index) {
+                const TempStorage& tempStorage = tempStorages[index];
+
+                // We use incomplete transaction hash for now as a metadata
+                sigma::SpendMetaData metaData(tempStorage.serializedId, tempStorage.blockHash, txHashForMetadata);
+
+                createdSpends[index].reset(new sigma::CoinSpend(sigmaParams,
+                                                                tempStorage.privateCoin,
+                                                                tempStorage.anonimity_set,
+                                                                metaData));
+                createdSpends[index]->setVersion(tempStorage.txVersion);
+                verifiedSpends[index] = createdSpends[index]->Verify(tempStorage.anonimity_set, metaData);
+            };
+
+            // A single spend is created here, so the proof spreads its own work over the pool
+            if (denominations.size() == 1) {
+                createSpend(0);
+            } else {
+                libzerocoin::ParallelTasks spendTasks(denominations.size());
+                for (size_t index = 0; index < denominations.size(); index++) {
+                    spendTasks.Add([&createSpend, index] { createSpend(index); });
+                }
+                spendTasks.Wait();
+            }
+
             std::vector<sigma::CoinSpend> spends;
             // Iterator of std::vector<std::pair<int64_t, sigma::CoinDenomination>>::const_iterator
             for (auto it = denominations.begin(); it != denominations.end(); it++)
             {
                 unsigned index = it - denominations.begin();
 
-                // We use incomplete transaction hash for now as a metadata
-                sigma::SpendMetaData metaData(
-                    tempStorages[index].serializedId,
-                    tempStorages[index].blockHash,
-                    txHashForMetadata);
-
-
                 TempStorage tempStorage = tempStorages.at(index);
                 CSigmaEntry coinToUse = tempStorage.coinToUse;
 
-                // Recreate CoinSpend object
-                sigma::CoinSpend spend(sigmaParams,
-                                       tempStorage.privateCoin,
-                                       tempStorage.anonimity_set,
-                                       metaData);
-                spend.setVersion(tempStorage.txVersion);
+                sigma::CoinSpend& spend = *createdSpends[index];
                 spends.push_back(spend);
                 // Verify the coinSpend
-                if (!spend.Verify(tempStorage.anonimity_set, metaData)) {
+                if (!verifiedSpends[index]) {
                     strFailReason = _("the spend coin transaction did not verify");
                     return false;
                 }